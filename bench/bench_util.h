@@ -0,0 +1,85 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: bench_util.h
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+#include "ICWFGM_Weather.h"
+#include "REDappWrapper.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+namespace bench
+{
+	/**
+	 * The wall clock time fn takes to run, in seconds.
+	 */
+	template<typename _Fn>
+	double Seconds(_Fn&& fn) {
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/**
+	 * The best of a number of runs of fn, in seconds. The first run is not timed so class
+	 * loading and the page cache don't count against it.
+	 */
+	template<typename _Fn>
+	double Best(int runs, _Fn&& fn) {
+		fn();
+		double best = 0.0;
+		for (int i = 0; i < runs; i++) {
+			double s = Seconds(fn);
+			if (i == 0 || s < best)
+				best = s;
+		}
+		return best;
+	}
+
+	/**
+	 * Load Java, printing why it couldn't be loaded if it fails.
+	 */
+	inline bool LoadJava() {
+		if (REDapp::REDappWrapper::CanLoadJava())
+			return true;
+		std::fprintf(stderr, "Java couldn't be loaded (%lu): %s\n%s\n", REDapp::REDappWrapper::JavaLoadError(),
+			REDapp::REDappWrapper::GetErrorDescription().c_str(), REDapp::REDappWrapper::GetDetailedError().c_str());
+		return false;
+	}
+
+	/**
+	 * Run this program again with different arguments, used for settings that can only be made
+	 * before Java is loaded.
+	 */
+	inline int RunSelf(const char* self, const std::vector<std::string>& args) {
+		std::string command = "\"" + std::string(self) + "\"";
+		for (const std::string& arg : args)
+			command += " \"" + arg + "\"";
+#ifdef _WIN32
+		//cmd strips the outer quotes from the whole command
+		command = "\"" + command + "\"";
+#endif
+		return std::system(command.c_str());
+	}
+}
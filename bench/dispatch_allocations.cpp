@@ -0,0 +1,101 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: dispatch_allocations.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Counts the heap allocations made by steady state calls, which should be none now that jobs
+ * are handed to the workers without being wrapped in a std::function. The count comes from
+ * replacing the global operator new, which the library only shares with this program where
+ * it's linked dynamically against the same C++ runtime, so the counts aren't meaningful on
+ * Windows.
+ *
+ * usage: dispatch_allocations [calls]
+ */
+
+#include "bench_util.h"
+
+#include <atomic>
+#include <new>
+#include <memory_resource>
+
+using namespace REDapp;
+
+
+static std::atomic<std::uint64_t> allocations{ 0 };
+
+void* operator new(std::size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+/**
+ * The number of allocations made by each call to fn, after a warm up call.
+ */
+template<typename _Fn>
+static double AllocationsPerCall(int calls, _Fn&& fn) {
+	fn();
+	std::uint64_t before = allocations.load(std::memory_order_relaxed);
+	for (int i = 0; i < calls; i++)
+		fn();
+	return (double)(allocations.load(std::memory_order_relaxed) - before) / calls;
+}
+
+int main(int argc, char* argv[]) {
+	int calls = argc > 1 ? std::atoi(argv[1]) : 10000;
+	if (calls <= 0)
+		calls = 10000;
+	if (!bench::LoadJava())
+		return 1;
+
+	int failed = 0;
+	auto report = [&failed](const char* name, double perCall) {
+		std::printf("%-32s %8.3f allocations/call\n", name, perCall);
+		if (perCall != 0.0)
+			failed = 1;
+	};
+
+	for (ExecutionMode mode : { ExecutionMode::WORKER, ExecutionMode::DIRECT }) {
+		REDappWrapper::SetExecutionMode(mode);
+		const char* name = mode == ExecutionMode::WORKER ? "worker" : "direct";
+		JavaWeatherStream stream;
+		double latitude = 45.0;
+		std::printf("%s\n", name);
+		report("  JavaWeatherStream::setLatitude", AllocationsPerCall(calls, [&]() { stream.setLatitude(latitude); }));
+		report("  JavaWeatherStream::setTimezone", AllocationsPerCall(calls, [&]() { stream.setTimezone(-6 * 3600); }));
+
+		//the result goes into a buffer on the stack so only the dispatch itself could allocate
+		Interpolator interpolator;
+		double houroffsets[] = { 0.0, 3.0, 6.0, 9.0, 12.0 };
+		double values[] = { 10.0, 12.0, 15.0, 13.0, 11.0 };
+		report("  Interpolator::SplineInterpolate", AllocationsPerCall(calls, [&]() {
+			unsigned char buffer[4096];
+			std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+			interpolator.SplineInterpolate(houroffsets, values, 5, &resource);
+		}));
+	}
+	return failed;
+}
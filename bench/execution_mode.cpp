@@ -0,0 +1,66 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: execution_mode.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Compares the worker and direct execution modes, for single small calls into Java and for
+ * whole imports when a file is given.
+ *
+ * usage: execution_mode [<hourly file>] [calls]
+ */
+
+#include "bench_util.h"
+
+using namespace REDapp;
+
+
+static void Measure(ExecutionMode mode, const char* name, const char* filename, int calls) {
+	REDappWrapper::SetExecutionMode(mode);
+	JavaWeatherStream stream;
+
+	std::uint64_t hops = REDappWrapper::JavaHopCount();
+	double seconds = bench::Best(3, [&stream, calls]() {
+		for (int i = 0; i < calls; i++)
+			stream.setLatitude(45.0 + (i % 10));
+	});
+	//hops are counted over every run, the warm up included
+	double hopsPerCall = (double)(REDappWrapper::JavaHopCount() - hops) / (4.0 * calls);
+	std::printf("%-8s %-12s %12.0f ns/call %6.2f hops/call\n", name, "setLatitude", seconds * 1e9 / calls, hopsPerCall);
+
+	if (filename) {
+		std::string file(filename);
+		long hr = 0;
+		size_t length = 0;
+		double import = bench::Best(3, [&stream, &file, &hr, &length]() {
+			delete[] stream.importHourly(file, &hr, &length);
+		});
+		std::printf("%-8s %-12s %12.3f ms       %6zu hours\n", name, "importHourly", import * 1e3, length);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	const char* filename = argc > 1 ? argv[1] : nullptr;
+	int calls = argc > 2 ? std::atoi(argv[2]) : 100000;
+	if (calls <= 0)
+		calls = 100000;
+	if (!bench::LoadJava())
+		return 1;
+
+	Measure(ExecutionMode::WORKER, "worker", filename, calls);
+	Measure(ExecutionMode::DIRECT, "direct", filename, calls);
+	return 0;
+}
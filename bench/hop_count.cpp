@@ -0,0 +1,82 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: hop_count.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Counts the hops to the Java worker thread each public call takes. Before transactions every
+ * JNI primitive was its own hop, so the count before is worked out from the primitives each call
+ * used to make, the count after is measured with REDappWrapper::JavaHopCount.
+ *
+ * usage: hop_count [calls]
+ */
+
+#include "bench_util.h"
+
+using namespace REDapp;
+
+
+/**
+ * The number of hops made by each call to fn, after a warm up call.
+ */
+template<typename _Fn>
+static double HopsPerCall(int calls, _Fn&& fn) {
+	fn();
+	std::uint64_t before = REDappWrapper::JavaHopCount();
+	for (int i = 0; i < calls; i++)
+		fn();
+	return (double)(REDappWrapper::JavaHopCount() - before) / calls;
+}
+
+int main(int argc, char* argv[]) {
+	int calls = argc > 1 ? std::atoi(argv[1]) : 1000;
+	if (calls <= 0)
+		calls = 1000;
+	if (!bench::LoadJava())
+		return 1;
+	REDappWrapper::SetExecutionMode(ExecutionMode::WORKER);
+
+	auto report = [](const char* name, double before, double after) {
+		std::printf("%-36s %10.1f %10.1f\n", name, before, after);
+	};
+	std::printf("%-36s %10s %10s\n", "hops/call", "before", "after");
+
+	JavaWeatherStream stream;
+	//GetMethod, CallMethod
+	report("JavaWeatherStream::setLatitude", 2, HopsPerCall(calls, [&]() { stream.setLatitude(45.0); }));
+	report("JavaWeatherStream::setTimezone", 2, HopsPerCall(calls, [&]() { stream.setTimezone(-6 * 3600); }));
+
+	Calendar calendar;
+	int year = 0;
+	//GetMethod, CallIntegerMethod
+	report("Calendar::getYear", 2, HopsPerCall(calls, [&]() { year += calendar.getYear(); }));
+
+	Interpolator interpolator;
+	constexpr int knots = 8;
+	double houroffsets[knots];
+	double values[knots];
+	for (int i = 0; i < knots; i++) {
+		houroffsets[i] = i * 3.0;
+		values[i] = 10.0 + i;
+	}
+	size_t results = interpolator.SplineInterpolate(houroffsets, values, knots).size();
+	//NewIntArray, GetClass, two GetMethod, two GetField, NewObjectArray, CallObjectMethodO and
+	//the array length, then NewObject, two SetDoubleField, SetObjectArrayElement and DeleteObject
+	//for every knot and GetArrayElement and two CallDoubleField for every result
+	double spline = 9.0 + 5.0 * knots + 3.0 * results;
+	report("Interpolator::SplineInterpolate", spline, HopsPerCall(calls, [&]() { interpolator.SplineInterpolate(houroffsets, values, knots); }));
+	return 0;
+}
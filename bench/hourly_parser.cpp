@@ -0,0 +1,69 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: hourly_parser.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Measures hourly import throughput in MB/s through Java and through the native parser.
+ *
+ * usage: hourly_parser <hourly file> [<hourly file>...]
+ */
+
+#include "bench_util.h"
+
+#include <filesystem>
+
+using namespace REDapp;
+
+
+static double Throughput(JavaWeatherStream::ImportParser parser, const std::vector<std::string>& files, double megabytes, size_t& hours) {
+	JavaWeatherStream stream;
+	stream.setImportParser(parser);
+	WeatherSeries series;
+	double seconds = bench::Best(5, [&]() {
+		hours = 0;
+		for (const std::string& file : files) {
+			stream.importHourly(file, series);
+			hours += series.size();
+		}
+	});
+	return megabytes / seconds;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s <hourly file> [<hourly file>...]\n", argv[0]);
+		return 2;
+	}
+	std::vector<std::string> files(argv + 1, argv + argc);
+	std::uintmax_t bytes = 0;
+	for (const std::string& file : files)
+		bytes += std::filesystem::file_size(file);
+	double megabytes = (double)bytes / (1024.0 * 1024.0);
+	if (!bench::LoadJava())
+		return 1;
+
+	size_t hours;
+	double java = Throughput(JavaWeatherStream::ImportParser::JAVA, files, megabytes, hours);
+	std::printf("java    %10.2f MB/s %10zu hours\n", java, hours);
+	double native = Throughput(JavaWeatherStream::ImportParser::NATIVE, files, megabytes, hours);
+	ImportStatistics stats = REDappWrapper::GetImportStatistics();
+	std::printf("native  %10.2f MB/s %10zu hours %8llu native %8llu fallbacks\n", native, hours,
+		(unsigned long long)stats.nativeImports, (unsigned long long)stats.javaFallbacks);
+	if (stats.nativeDisabled)
+		std::printf("the native parser didn't match Java and was turned off, run hourly_parser_conformance on these files\n");
+	return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: id_cache.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Counts the class, method and field lookups made in Java by each hourly import. Every miss in
+ * the cache is one FindClass, GetMethodID or GetFieldID call, so after the lookups made while
+ * Java loads an import should make none.
+ *
+ * usage: id_cache <hourly file> [imports]
+ */
+
+#include "bench_util.h"
+
+using namespace REDapp;
+
+
+static void Print(const char* name, const CacheStatistics& before, const CacheStatistics& after, int imports) {
+	std::printf("%-10s %10.2f %10.2f %10.2f %12.2f\n", name,
+		(double)(after.classMisses - before.classMisses) / imports,
+		(double)(after.methodMisses - before.methodMisses) / imports,
+		(double)(after.fieldMisses - before.fieldMisses) / imports,
+		(double)((after.classHits + after.methodHits + after.fieldHits) - (before.classHits + before.methodHits + before.fieldHits)) / imports);
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s <hourly file> [imports]\n", argv[0]);
+		return 2;
+	}
+	std::string filename(argv[1]);
+	int imports = argc > 2 ? std::atoi(argv[2]) : 100;
+	if (imports <= 0)
+		imports = 100;
+	if (!bench::LoadJava())
+		return 1;
+
+	CacheStatistics loaded = REDappWrapper::GetCacheStatistics();
+	std::printf("loading   %10llu %10llu %10llu\n", (unsigned long long)loaded.classMisses,
+		(unsigned long long)loaded.methodMisses, (unsigned long long)loaded.fieldMisses);
+
+	std::printf("per import  FindClass GetMethodID GetFieldID  cache hits\n");
+	JavaWeatherStream stream;
+	long hr = 0;
+	size_t length = 0;
+	CacheStatistics before = REDappWrapper::GetCacheStatistics();
+	delete[] stream.importHourly(filename, &hr, &length);
+	CacheStatistics first = REDappWrapper::GetCacheStatistics();
+	Print("first", before, first, 1);
+
+	for (int i = 0; i < imports; i++)
+		delete[] stream.importHourly(filename, &hr, &length);
+	CacheStatistics steady = REDappWrapper::GetCacheStatistics();
+	Print("steady", first, steady, imports);
+	return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: import_transfer.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Measures how many imported hours per second are copied out of Java, in bulk through the
+ * wrapper's Java adapter and one field at a time. The Java import itself isn't timed, only
+ * reading the imported hours back. The bulk figure is only meaningful when
+ * REDappWrapperAdapter.jar is installed beside the REDapp jars.
+ *
+ * usage: import_transfer <hourly file> [chunk hours]
+ */
+
+#include "bench_util.h"
+
+#include <algorithm>
+
+using namespace REDapp;
+
+
+/**
+ * The best rate hours are read back from an import at, in hours per second.
+ */
+static double HoursPerSecond(JavaWeatherStream& stream, const std::string& file, size_t chunk, size_t& hours) {
+	double best = 0.0;
+	for (int run = 0; run < 6; run++) {
+		HourlyReader reader = stream.openHourly(file);
+		hours = reader.remaining();
+		WeatherSeries series;
+		double seconds = bench::Seconds([&]() {
+			while (reader.read(series, chunk) > 0);
+		});
+		//the first run warms up the JIT and isn't counted
+		if (run > 0 && seconds > 0.0)
+			best = std::max(best, hours / seconds);
+	}
+	return best;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s <hourly file> [chunk hours]\n", argv[0]);
+		return 2;
+	}
+	std::string file = argv[1];
+	size_t chunk = argc > 2 ? (size_t)std::atoll(argv[2]) : 0;
+	if (chunk == 0)
+		chunk = (size_t)-1;
+	if (!bench::LoadJava())
+		return 1;
+
+	JavaWeatherStream stream;
+	size_t hours = 0;
+	REDappWrapper::SetBulkTransfers(false);
+	double fields = HoursPerSecond(stream, file, chunk, hours);
+	REDappWrapper::SetBulkTransfers(true);
+	double bulk = HoursPerSecond(stream, file, chunk, hours);
+	std::printf("%zu hours\n", hours);
+	std::printf("per field %14.0f rows/s\n", fields);
+	std::printf("bulk      %14.0f rows/s %8.2fx\n", bulk, fields > 0.0 ? bulk / fields : 0.0);
+	return 0;
+}
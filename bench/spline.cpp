@@ -0,0 +1,85 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: spline.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Times spline interpolation with the Java and native engines, one series at a time and many
+ * series sharing the same hour offsets at once. Java is timed passing a HourValue object per
+ * point and, when REDappWrapperAdapter.jar is installed, passing primitive arrays.
+ *
+ * usage: spline [series]
+ */
+
+#include "bench_util.h"
+
+#include <random>
+
+using namespace REDapp;
+
+
+int main(int argc, char* argv[]) {
+	int count = argc > 1 ? std::atoi(argv[1]) : 1000;
+	if (count <= 0)
+		count = 1000;
+	if (!bench::LoadJava())
+		return 1;
+
+	//a 10 day, 3 hourly forecast
+	constexpr int size = 80;
+	std::vector<double> offsets(size);
+	for (int i = 0; i < size; i++)
+		offsets[i] = i * 3.0;
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> value(-30.0, 40.0);
+	std::vector<std::vector<double>> values(count, std::vector<double>(size));
+	std::vector<Interpolator::SplineSeries> series(count);
+	for (int i = 0; i < count; i++) {
+		for (double& v : values[i])
+			v = value(random);
+		series[i].houroffsets = offsets.data();
+		series[i].values = values[i].data();
+		series[i].size = size;
+	}
+
+	struct engine_case {
+		const char* name;
+		Interpolator::SplineEngine engine;
+		bool bulk;
+	};
+	const engine_case cases[] = {
+		{ "java-obj", Interpolator::SplineEngine::JAVA, false },
+		{ "java-arr", Interpolator::SplineEngine::JAVA, true },
+		{ "native", Interpolator::SplineEngine::NATIVE, true }
+	};
+
+	Interpolator interpolator;
+	std::printf("engine     single (us/series)   many (us/series)\n");
+	for (const engine_case& c : cases) {
+		REDappWrapper::SetBulkTransfers(c.bulk);
+		interpolator.setEngine(c.engine);
+		double single = bench::Best(3, [&]() {
+			for (int i = 0; i < count; i++)
+				interpolator.SplineInterpolate(offsets.data(), values[i].data(), size);
+		});
+		double many = bench::Best(3, [&]() {
+			interpolator.SplineInterpolateMany(series);
+		});
+		std::printf("%-10s %19.2f %18.2f\n", c.name, single * 1e6 / count, many * 1e6 / count);
+	}
+	REDappWrapper::SetBulkTransfers(true);
+	return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: worker_scaling.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Imports the same set of hourly weather files with 1 to N Java worker threads and prints the
+ * import rate for each. The worker count can only be set before Java is loaded so each count
+ * runs in a process of its own.
+ *
+ * usage: worker_scaling <max threads> <hourly file> [<hourly file>...]
+ */
+
+#include "bench_util.h"
+
+#include <cstring>
+#include <algorithm>
+
+using namespace REDapp;
+
+
+/**
+ * How many times each file is imported per run. The work is the same for every thread count
+ * so the times can be compared directly.
+ */
+static constexpr int ImportsPerFile = 16;
+
+static int RunWith(size_t threads, int argc, char* argv[]) {
+	REDappWrapper::SetWorkerCount(threads);
+	if (!bench::LoadJava())
+		return 1;
+
+	std::vector<JavaWeatherStream::ImportSpec> specs;
+	for (int i = 0; i < ImportsPerFile; i++) {
+		for (int j = 0; j < argc; j++) {
+			JavaWeatherStream::ImportSpec spec;
+			spec.filename = argv[j];
+			specs.push_back(spec);
+		}
+	}
+
+	size_t failed = 0;
+	double seconds = bench::Best(3, [&specs, &failed]() {
+		failed = 0;
+		for (const JavaWeatherStream::ImportResult& result : JavaWeatherStream::importHourlyMany(specs)) {
+			if (result.series.size() == 0)
+				failed++;
+		}
+	});
+	WorkerStatistics stats = REDappWrapper::GetWorkerStatistics();
+	std::printf("%7zu %10.3f %12.1f %10llu %8zu\n", threads, seconds, specs.size() / seconds,
+		(unsigned long long)stats.steals, failed);
+	return failed ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc > 3 && std::strcmp(argv[1], "--run") == 0)
+		return RunWith(std::strtoul(argv[2], nullptr, 10), argc - 3, argv + 3);
+	if (argc < 3) {
+		std::fprintf(stderr, "usage: %s <max threads> <hourly file> [<hourly file>...]\n", argv[0]);
+		return 2;
+	}
+
+	size_t max = std::max<size_t>(std::strtoul(argv[1], nullptr, 10), 1);
+	std::vector<size_t> counts;
+	for (size_t n = 1; n < max; n *= 2)
+		counts.push_back(n);
+	counts.push_back(max);
+
+	std::printf("threads    seconds   imports/s     steals   failed\n");
+	std::fflush(stdout);
+	int result = 0;
+	for (size_t n : counts) {
+		std::vector<std::string> args = { "--run", std::to_string(n) };
+		args.insert(args.end(), argv + 2, argv + argc);
+		if (bench::RunSelf(argv[0], args) != 0)
+			result = 1;
+	}
+	return result;
+}
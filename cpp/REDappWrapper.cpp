@@ -23,6 +23,10 @@
 #include "REDappWrapper.h"
 #include "jvm_wrapper.h"
 #include "java_types.h"
+#include "java_registry.h"
+#include "hourly_parser.h"
+#include "spline.h"
+#include "forecast_cache.h"
 
 #include <map>
 #include <sys/stat.h>
@@ -30,1809 +34,3596 @@
 #include <sstream>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <future>
 #include <list>
+#include <deque>
 #include <wchar.h>
 #include <jni.h>
 #include <functional>
+#include <atomic>
+#include <type_traits>
+#include <chrono>
+#include <optional>
+#include <algorithm>
+#include <new>
+#include <cstddef>
+#include <shared_mutex>
+#include <unordered_set>
+#include <unordered_map>
+#include <string_view>
+#include <utility>
+#include <memory_resource>
+#include <cmath>
 
 #include <boost/utility.hpp>
 #define BOOST_SERIALIZATION_NO_LIB //I only want singleton, not all of the serialization library
 #include <boost/serialization/singleton.hpp>
 
 
-#define CACHE_FIELD_VALUES 0
-#define CACHE_METHOD_VALUES 0
-#define CACHE_CLASS_VALUES 0
-
+/**
+ * Caches IDs looked up from Java in an open addressing hash table keyed on a class and the
+ * name and signature of one of its members. The strings are interned the first time they are
+ * seen so entries never point at a caller's buffer. Every class used as a key has to be a global
+ * reference. Reloading Java bumps the generation, which empties the table in one step since
+ * entries from an older generation are treated as free slots. Failed lookups are cached too so
+ * probing for an optional member only costs one call into Java.
+ */
+template<typename T>
+class JavaIDCache {
+	struct slot {
+		uint32_t generation{ 0 };
+		size_t hash{ 0 };
+		jclass cls{ nullptr };
+		std::string_view name;
+		std::string_view sig;
+		T value{};
+	};
 
-template<typename store>
-class REDappWrapperCache {
-protected:
-	struct cache_entry {
-		cache_entry(size_t key, store value)
-			: key(key),
-			  value(value) {
+public:
+	/**
+	 * Find a cached ID, calling resolve to look it up in Java if it isn't cached yet.
+	 */
+	template<typename _Resolve>
+	T get(jclass cls, const char* name, const char* sig, _Resolve&& resolve) {
+		size_t hash = Hash(cls, name, sig);
+		{
+			std::shared_lock<std::shared_mutex> lock(m_lock);
+			if (const slot* s = find(hash, cls, name, sig)) {
+				m_hits.fetch_add(1, std::memory_order_relaxed);
+				return s->value;
+			}
 		}
+		m_misses.fetch_add(1, std::memory_order_relaxed);
+		T value = resolve();
+		std::unique_lock<std::shared_mutex> lock(m_lock);
+		//another worker may have resolved the same ID while we were in Java
+		if (const slot* s = find(hash, cls, name, sig))
+			return s->value;
+		insert(hash, cls, intern(name), intern(sig), value);
+		return value;
+	}
 
-		size_t key;
-		store value;
-	};
-
-	typedef std::map<size_t, cache_entry> Data;
+	/**
+	 * Forget every cached ID.
+	 */
+	void invalidate() {
+		std::unique_lock<std::shared_mutex> lock(m_lock);
+		m_generation++;
+		m_count = 0;
+	}
 
-	Data data;
+	inline std::uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+	inline std::uint64_t misses() const { return m_misses.load(std::memory_order_relaxed); }
 
-public:
-	REDappWrapperCache() {
-		const wchar_t * c = L"", * d = L"";
-		wmemcmp(c, d, 0);
+private:
+	static size_t Hash(jclass cls, const char* name, const char* sig) {
+		//FNV-1a over both strings, seeded with the class
+		uint64_t hash = 14695981039346656037ULL ^ (uint64_t)(uintptr_t)cls;
+		for (const char* c = name; *c; c++)
+			hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+		hash = (hash ^ 0xff) * 1099511628211ULL;
+		for (const char* c = sig; *c; c++)
+			hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+		return (size_t)hash;
 	}
 
-	void add(size_t key, store value) {
-		typename Data::iterator find = data.find(key);
-		if (find != data.end())
-			find->second.value = value;
-		else
-			data.insert(std::make_pair(key, cache_entry(key, value)));
+	inline bool live(const slot& s) const { return s.generation == m_generation; }
+
+	const slot* find(size_t hash, jclass cls, const char* name, const char* sig) const {
+		if (m_slots.empty())
+			return nullptr;
+		size_t mask = m_slots.size() - 1;
+		for (size_t i = hash & mask; live(m_slots[i]); i = (i + 1) & mask) {
+			const slot& s = m_slots[i];
+			if (s.hash == hash && s.cls == cls && s.name == name && s.sig == sig)
+				return &s;
+		}
+		return nullptr;
+	}
+
+	void insert(size_t hash, jclass cls, std::string_view name, std::string_view sig, T value) {
+		//keep the table at most half full so probe sequences stay short
+		if ((m_count + 1) * 2 > m_slots.size())
+			grow();
+		size_t mask = m_slots.size() - 1;
+		size_t i = hash & mask;
+		while (live(m_slots[i]))
+			i = (i + 1) & mask;
+		m_slots[i] = slot{ m_generation, hash, cls, name, sig, value };
+		m_count++;
+	}
+
+	void grow() {
+		std::vector<slot> old(std::max<size_t>(m_slots.size() * 2, 64));
+		old.swap(m_slots);
+		m_count = 0;
+		for (const slot& s : old) {
+			if (live(s))
+				insert(s.hash, s.cls, s.name, s.sig, s.value);
+		}
 	}
 
-	void clear() {
-		data.clear();
+	std::string_view intern(const char* str) {
+		return *m_strings.emplace(str).first;
 	}
+
+private:
+	std::shared_mutex m_lock;
+	std::vector<slot> m_slots;
+	size_t m_count{ 0 };
+	uint32_t m_generation{ 1 };
+	std::unordered_set<std::string> m_strings;
+	std::atomic<std::uint64_t> m_hits{ 0 };
+	std::atomic<std::uint64_t> m_misses{ 0 };
 };
 
 
-class REDappWrapperCache_class : public REDappWrapperCache<jclass> {
+/**
+ * A bounded ring buffer that any number of threads can push to without taking a lock. Each
+ * cell carries a sequence number that tells producers and the consumer whether the cell is
+ * free, being written, or ready to be read (Vyukov's bounded queue).
+ */
+template<typename T, size_t _Capacity>
+class JobRing {
+	static_assert((_Capacity & (_Capacity - 1)) == 0, "The ring capacity must be a power of two.");
+	static constexpr size_t mask = _Capacity - 1;
+
+	struct cell {
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
 public:
-	REDappWrapperCache_class()
-		: REDappWrapperCache() {
+	JobRing() {
+		for (size_t i = 0; i < _Capacity; i++)
+			m_buffer[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	/**
+	 * Add an item to the ring. The item is only moved from if the push succeeds.
+	 * @returns false if the ring is full.
+	 */
+	bool push(T& data) {
+		cell* c;
+		size_t pos = m_enqueue.load(std::memory_order_relaxed);
+		while (true) {
+			c = &m_buffer[pos & mask];
+			size_t seq = c->sequence.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+			if (dif == 0) {
+				if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (dif < 0)
+				return false;
+			else
+				pos = m_enqueue.load(std::memory_order_relaxed);
+		}
+		c->data = std::move(data);
+		c->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Remove the oldest item from the ring.
+	 * @returns false if the ring is empty.
+	 */
+	bool pop(T& data) {
+		cell* c;
+		size_t pos = m_dequeue.load(std::memory_order_relaxed);
+		while (true) {
+			c = &m_buffer[pos & mask];
+			size_t seq = c->sequence.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+			if (dif == 0) {
+				if (m_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (dif < 0)
+				return false;
+			else
+				pos = m_dequeue.load(std::memory_order_relaxed);
+		}
+		data = std::move(c->data);
+		c->sequence.store(pos + mask + 1, std::memory_order_release);
+		return true;
 	}
 
-	jclass create(std::string name, NativeJVM* env) {
-#if CACHE_CLASS_VALUES
-		size_t key = std::hash<std::string>()(name);
-		Data::iterator find = data.find(key);
-		if (find != data.end())
-			return find->second.value;
-		else
-		{
-			jclass value = env->FindClass(name.c_str());
-			data.insert(std::make_pair(key, cache_entry(key, value)));
-			return value;
-		}
-#else
-		return env->FindClass(name);
-#endif
+	/**
+	 * An approximation of the number of items in the ring.
+	 */
+	size_t size() const {
+		size_t enq = m_enqueue.load(std::memory_order_relaxed);
+		size_t deq = m_dequeue.load(std::memory_order_relaxed);
+		return enq > deq ? enq - deq : 0;
 	}
+
+private:
+	cell m_buffer[_Capacity];
+	alignas(64) std::atomic<size_t> m_enqueue{ 0 };
+	alignas(64) std::atomic<size_t> m_dequeue{ 0 };
 };
 
-class REDappWrapperCache_method : public REDappWrapperCache<jmethodID> {
+/**
+ * A move only callable that keeps its target in an inline buffer instead of on the heap, so
+ * handing a job to a worker never allocates. Targets that don't fit are rejected at compile
+ * time. Synchronous jobs should capture by reference since the caller waits for them, jobs that
+ * outlive the caller have to box their own state.
+ */
+template<size_t _Capacity>
+class InlineJob {
 public:
-	REDappWrapperCache_method()
-		: REDappWrapperCache() {
+	InlineJob() noexcept = default;
+	InlineJob(std::nullptr_t) noexcept { }
+
+	template<typename _Fn, typename = std::enable_if_t<!std::is_same_v<std::decay_t<_Fn>, InlineJob>>>
+	InlineJob(_Fn&& fn) {
+		typedef std::decay_t<_Fn> target_t;
+		static_assert(sizeof(target_t) <= _Capacity, "The job captures too much state to be stored inline.");
+		static_assert(alignof(target_t) <= alignof(std::max_align_t), "The job is over aligned.");
+		new (m_storage) target_t(std::forward<_Fn>(fn));
+		m_ops = &operations_for<target_t>;
 	}
 
-	jmethodID create(jclass cls, std::string clsname, std::string name, std::string sig, NativeJVM* env) {
-#if CACHE_METHOD_VALUES
-		std::string keystring = clsname + name + sig;
-		size_t key = std::hash<std::string>()(keystring);
-		Data::iterator find = data.find(key);
-		if (find != data.end())
-			return find->second.value;
-		else {
-			jmethodID value = env->GetMethodID(cls, name.c_str(), sig.c_str());
-			data.insert(std::make_pair(key, cache_entry(key, value)));
-			return value;
-		}
-#else
-		return env->GetMethodID(cls, name, sig);
-#endif
+	InlineJob(InlineJob&& other) noexcept {
+		take(other);
 	}
 
-	jmethodID createStatic(jclass cls, std::string clsname, std::string name, std::string sig, NativeJVM* env) {
-#if CACHE_METHOD_VALUES
-		std::string keystring = clsname + name + sig;
-		size_t key = std::hash<std::string>()(keystring);
-		Data::iterator find = data.find(key);
-		if (find != data.end())
-			return find->second.value;
-		else {
-			jmethodID value = env->GetStaticMethodID(cls, name.c_str(), sig.c_str());
-			data.insert(std::make_pair(key, cache_entry(key, value)));
-			return value;
+	InlineJob& operator = (InlineJob&& other) noexcept {
+		if (this != &other) {
+			reset();
+			take(other);
 		}
-#else
-		return env->GetStaticMethodID(cls, name, sig);
-#endif
+		return *this;
 	}
-};
 
-class REDappWrapperCache_field: public REDappWrapperCache<jfieldID> {
-public:
-	REDappWrapperCache_field()
-		: REDappWrapperCache() {
+	InlineJob& operator = (std::nullptr_t) noexcept {
+		reset();
+		return *this;
 	}
 
-	jfieldID create(jclass cls, std::string clsname, std::string name, std::string sig, NativeJVM* env) {
-#if CACHE_FIELD_VALUES
-		std::string keystring = clsname + name + sig;
-		size_t key = std::hash<std::string>()(keystring);
-		Data::iterator find = data.find(key);
-		if (find != data.end())
-			return find->second.value;
-		else {
-			jfieldID value = env->GetFieldID(cls, name.c_str(), sig.c_str());
-			data.insert(std::make_pair(key, cache_entry(key, value)));
-			return value;
+	~InlineJob() {
+		reset();
+	}
+
+	explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+	void operator()() { m_ops->invoke(m_storage); }
+
+private:
+	struct operations {
+		void (*invoke)(void*);
+		void (*move)(void* to, void* from) noexcept;
+		void (*destroy)(void*) noexcept;
+	};
+
+	template<typename T>
+	static constexpr operations operations_for = {
+		[](void* target) { (*static_cast<T*>(target))(); },
+		[](void* to, void* from) noexcept { new (to) T(std::move(*static_cast<T*>(from))); static_cast<T*>(from)->~T(); },
+		[](void* target) noexcept { static_cast<T*>(target)->~T(); }
+	};
+
+	void take(InlineJob& other) noexcept {
+		if (other.m_ops) {
+			other.m_ops->move(m_storage, other.m_storage);
+			m_ops = other.m_ops;
+			other.m_ops = nullptr;
 		}
-#else
-		return env->GetFieldID(cls, name, sig);
-#endif
 	}
 
-	jfieldID createStatic(jclass cls, std::string clsname, std::string name, std::string sig, NativeJVM* env) {
-#if CACHE_FIELD_VALUES
-		std::string keystring = clsname + name + sig;
-		size_t key = std::hash<std::string>()(keystring);
-		Data::iterator find = data.find(key);
-		if (find != data.end())
-			return find->second.value;
-		else {
-			jfieldID value = env->GetStaticFieldID(cls, name.c_str(), sig.c_str());
-			data.insert(std::make_pair(key, cache_entry(key, value)));
-			return value;
+	void reset() noexcept {
+		if (m_ops) {
+			m_ops->destroy(m_storage);
+			m_ops = nullptr;
 		}
-#else
-		return env->GetStaticFieldID(cls, name, sig);
-#endif
 	}
+
+	alignas(std::max_align_t) unsigned char m_storage[_Capacity];
+	const operations* m_ops = nullptr;
+
+	InlineJob(const InlineJob&) = delete;
+	InlineJob& operator = (const InlineJob&) = delete;
 };
 
+class WorkerPool;
+
 class WorkerThread {
 public:
-	typedef std::function<void()> job_t;
+	typedef InlineJob<64> job_t;
+	typedef std::chrono::steady_clock clock_t;
+
+	/**
+	 * Lets a caller wait for a job without allocating a shared state the way a promise would.
+	 * Lives on the waiting caller's stack, so the worker signals it while holding the lock. The
+	 * waiter can't get past wait() until the worker has let go of the lock and no longer touches it.
+	 */
+	struct completion {
+		std::mutex lock;
+		std::condition_variable cv;
+		bool done{ false };
+		std::exception_ptr error;
+
+		/**
+		 * Wait for the job to finish, rethrowing anything it threw.
+		 */
+		void wait() {
+			std::unique_lock<std::mutex> l(lock);
+			cv.wait(l, [this] { return done; });
+			l.unlock();
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+		/**
+		 * Mark the job as finished and wake the waiter.
+		 */
+		void signal() {
+			std::lock_guard<std::mutex> l(lock);
+			done = true;
+			cv.notify_one();
+		}
+	};
+
+	struct queued_job {
+		job_t job;
+		completion* done;
+		clock_t::time_point queued;
+	};
+
+private:
+	static constexpr size_t ring_size = 1024;
 
-	WorkerThread() {
+public:
+	/**
+	 * @param pool The pool the worker belongs to, used to steal shared jobs from the other workers.
+	 * @param start Run on the new thread before it accepts any jobs.
+	 * @param stop Run on the thread just before it exits.
+	 */
+	WorkerThread(WorkerPool* pool = nullptr, job_t start = nullptr, job_t stop = nullptr)
+		: m_pool(pool), m_start(std::move(start)), m_stop(std::move(stop)) {
 		m_exit = false;
-		m_hasjob = false;
 		m_thread = std::unique_ptr<std::thread>(new std::thread(std::bind(&WorkerThread::Entry, this)));
 	}
 
 	~WorkerThread() {
-		{
-			std::lock_guard<std::mutex> lock(m_locker);
+		shutdown();
+	}
+
+	/**
+	 * Stop accepting jobs and wait for the thread to exit.
+	 */
+	void shutdown() {
+		if (m_thread) {
 			m_exit = true;
-			m_jobPending.notify_one();
+			wake();
+			m_thread->join();
+			m_thread.reset();
 		}
-		m_thread->join();
 	}
 
-	void runJob(job_t job) {
-		std::unique_lock<std::mutex> lock(m_locker);
-		m_job = job;
-		m_hasjob = true;
-		m_jobPending.notify_one();
+	/**
+	 * Queue a job that must run on this worker without waiting for it to run.
+	 * @param done Signalled when the job has completed, if the job throws the exception is stored in it.
+	 */
+	void post(job_t job, completion* done = nullptr) {
+		enqueue(m_jobs, std::move(job), done);
+	}
+
+	/**
+	 * Queue a job that may be stolen by any other worker in the pool.
+	 */
+	void share(job_t job, completion* done = nullptr) {
+		enqueue(m_shared, std::move(job), done);
+	}
+
+	/**
+	 * Run a job on the worker thread and wait for it to complete. Only a reference to the job is
+	 * queued, so it can capture anything the caller has on its stack.
+	 */
+	void runJob(job_t& job) {
+		completion done;
+		post([&job] { job(); }, &done);
+		done.wait();
+	}
+
+	/**
+	 * Take a shared job from this worker for another worker to run.
+	 */
+	bool steal(std::optional<queued_job>& q) {
+		return m_shared.pop(q);
+	}
+
+	inline void wake() {
+		m_signal.fetch_add(1, std::memory_order_release);
+		m_signal.notify_one();
+	}
+
+	inline bool idle() const { return m_idle.load(std::memory_order_acquire); }
+
+	/**
+	 * The worker that is running on the calling thread, or nullptr if the caller isn't a worker.
+	 */
+	static inline WorkerThread* current() { return s_current; }
 
-		m_jobComplete.wait(lock, [&]() { return !m_hasjob; });
+	void statistics(REDapp::WorkerStatistics& stats) const {
+		stats.jobs += m_completed.load(std::memory_order_relaxed);
+		stats.queueDepth += m_jobs.size() + m_shared.size();
+		stats.maxQueueDepth = std::max(stats.maxQueueDepth, m_maxDepth.load(std::memory_order_relaxed));
+		stats.totalWaitNanoseconds += m_totalWait.load(std::memory_order_relaxed);
+		stats.maxWaitNanoseconds = std::max(stats.maxWaitNanoseconds, m_maxWait.load(std::memory_order_relaxed));
+		stats.queueFullWaits += m_fullWaits.load(std::memory_order_relaxed);
+		stats.steals += m_steals.load(std::memory_order_relaxed);
 	}
 
 private:
-	void Entry() {
-		while (true) {
-			std::unique_lock<std::mutex> tlock(m_locker);
-			m_jobPending.wait(tlock, [&]() { return m_exit || m_hasjob; });
+	void enqueue(JobRing<std::optional<queued_job>, ring_size>& ring, job_t job, completion* done) {
+		std::optional<queued_job> q{ queued_job{ std::move(job), done, clock_t::now() } };
+		//the ring is full, let the worker catch up
+		while (!ring.push(q)) {
+			m_fullWaits.fetch_add(1, std::memory_order_relaxed);
+			std::this_thread::yield();
+		}
+		uint64_t depth = m_jobs.size() + m_shared.size();
+		uint64_t max = m_maxDepth.load(std::memory_order_relaxed);
+		while (depth > max && !m_maxDepth.compare_exchange_weak(max, depth, std::memory_order_relaxed));
+		wake();
+	}
 
-			if (m_exit)
-				return;
+	void execute(std::optional<queued_job>& q) {
+		uint64_t wait = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - q->queued).count();
+		m_totalWait.fetch_add(wait, std::memory_order_relaxed);
+		uint64_t max = m_maxWait.load(std::memory_order_relaxed);
+		while (wait > max && !m_maxWait.compare_exchange_weak(max, wait, std::memory_order_relaxed));
 
-			m_job();
-			
-			m_hasjob = false;
-			m_jobComplete.notify_one();
+		completion* done = q->done;
+		try {
+			q->job();
+		}
+		catch (...) {
+			if (done)
+				done->error = std::current_exception();
 		}
+		q.reset();
+		m_completed.fetch_add(1, std::memory_order_relaxed);
+		if (done)
+			done->signal();
 	}
 
+	void Entry();
+
 public:
 	std::unique_ptr<std::thread> m_thread;
-	std::condition_variable m_jobPending;
-	std::condition_variable m_jobComplete;
-	job_t m_job;
-	std::mutex m_locker;
-	bool m_hasjob;
-	bool m_exit;
+	WorkerPool* m_pool;
+	job_t m_start;
+	job_t m_stop;
+	JobRing<std::optional<queued_job>, ring_size> m_jobs;
+	JobRing<std::optional<queued_job>, ring_size> m_shared;
+	std::atomic<uint32_t> m_signal{ 0 };
+	std::atomic<bool> m_exit;
+	std::atomic<bool> m_idle{ false };
+	std::atomic<uint64_t> m_completed{ 0 };
+	std::atomic<uint64_t> m_maxDepth{ 0 };
+	std::atomic<uint64_t> m_totalWait{ 0 };
+	std::atomic<uint64_t> m_maxWait{ 0 };
+	std::atomic<uint64_t> m_fullWaits{ 0 };
+	std::atomic<uint64_t> m_steals{ 0 };
+
+	static inline thread_local WorkerThread* s_current = nullptr;
 
 	WorkerThread(const WorkerThread&);
 	WorkerThread& operator = (const WorkerThread&);
 };
 
-class REDappWrapperPrivate : public boost::serialization::singleton<REDappWrapperPrivate> {
+/**
+ * A fixed size set of worker threads. The first worker is the primary worker and is the only
+ * one that runs pinned jobs, which is where any job that uses local references has to go. Shared
+ * jobs are spread across the workers and idle workers steal them from busy ones.
+ */
+class WorkerPool {
 public:
-	REDappWrapperPrivate() : m_thread(nullptr), m_jvm(nullptr) { }
-	virtual ~REDappWrapperPrivate();
+	explicit WorkerPool(size_t capacity)
+		: m_capacity(std::max<size_t>(capacity, 1)),
+		  m_workers(new std::unique_ptr<WorkerThread>[m_capacity]) {
+	}
+
+	~WorkerPool() {
+		size_t count = size();
+		//stop every worker before any are destroyed so nobody steals from a dead ring
+		for (size_t i = count; i > 0; i--)
+			m_workers[i - 1]->shutdown();
+	}
+
+	/**
+	 * Add a worker to the pool.
+	 * @returns false if the pool is already full.
+	 */
+	bool add(WorkerThread::job_t start, WorkerThread::job_t stop) {
+		size_t index = m_count.load(std::memory_order_relaxed);
+		if (index >= m_capacity)
+			return false;
+		m_workers[index] = std::make_unique<WorkerThread>(this, std::move(start), std::move(stop));
+		m_count.store(index + 1, std::memory_order_release);
+		return true;
+	}
+
+	inline size_t size() const { return m_count.load(std::memory_order_acquire); }
+	inline WorkerThread* primary() { return m_workers[0].get(); }
+
+	/**
+	 * Queue a job that can run on any worker.
+	 * @param done Signalled when the job has completed.
+	 */
+	void submit(WorkerThread::job_t job, WorkerThread::completion* done = nullptr) {
+		size_t count = size();
+		size_t target = m_next.fetch_add(1, std::memory_order_relaxed) % count;
+		m_workers[target]->share(std::move(job), done);
+		//give an idle worker the chance to take it if the target is busy
+		if (!m_workers[target]->idle()) {
+			for (size_t i = 1; i < count; i++) {
+				WorkerThread* w = m_workers[(target + i) % count].get();
+				if (w->idle()) {
+					w->wake();
+					break;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Take a shared job from any worker other than the thief.
+	 */
+	bool steal(WorkerThread* thief, std::optional<WorkerThread::queued_job>& q) {
+		size_t count = size();
+		for (size_t i = 0; i < count; i++) {
+			WorkerThread* w = m_workers[i].get();
+			if (w != thief && w->steal(q))
+				return true;
+		}
+		return false;
+	}
+
+	void statistics(REDapp::WorkerStatistics& stats) const {
+		size_t count = size();
+		stats.workers = count;
+		for (size_t i = 0; i < count; i++)
+			m_workers[i]->statistics(stats);
+	}
 
 private:
-	inline void init() { std::lock_guard<std::mutex> lock(m_initLock); if (m_jvm == nullptr || !m_jvm->IsValid()) _init(); }
-	void _init();
+	size_t m_capacity;
+	std::unique_ptr<std::unique_ptr<WorkerThread>[]> m_workers;
+	std::atomic<size_t> m_count{ 0 };
+	std::atomic<size_t> m_next{ 0 };
+};
+
+void WorkerThread::Entry() {
+	s_current = this;
+	if (m_start)
+		m_start();
+
+	std::optional<queued_job> q;
+	while (true) {
+		//read the signal before draining so a job pushed after the rings look empty still wakes us
+		uint32_t seen = m_signal.load(std::memory_order_acquire);
+		bool worked = false;
+		while (m_jobs.pop(q)) {
+			execute(q);
+			worked = true;
+		}
+		//only take one shared job at a time so pinned jobs aren't held up
+		if (m_shared.pop(q)) {
+			execute(q);
+			continue;
+		}
+		if (m_pool && m_pool->steal(this, q)) {
+			m_steals.fetch_add(1, std::memory_order_relaxed);
+			execute(q);
+			continue;
+		}
+		if (worked)
+			continue;
+
+		if (m_exit)
+			break;
+
+		m_idle.store(true, std::memory_order_release);
+		m_signal.wait(seen, std::memory_order_acquire);
+		m_idle.store(false, std::memory_order_release);
+	}
+
+	if (m_stop)
+		m_stop();
+}
 
+/**
+ * Threads that resume coroutines whose Awaitable wasn't given an executor. The Java workers can't
+ * resume them since the coroutine would hold up the worker until its next suspension. Whatever
+ * is still queued when the pool is destroyed is resumed before the threads exit.
+ */
+class ResumerPool {
 public:
-	int run(WorkerThread::job_t job);
-
-	jclass GetClass(const std::string& name);
-	jmethodID GetMethod(REDapp::JavaClassDef& cls, const std::string& name, const std::string& sig);
-	jmethodID GetMethod(jclass cls, const std::string& clsname, const std::string& name, const std::string& sig);
-	jmethodID GetStaticMethod(REDapp::JavaClassDef& cls, const std::string& name, const std::string& sig);
-	jmethodID GetStaticMethod(jclass cls, const std::string& clsname, const std::string& name, const std::string& sig);
-	jfieldID GetStaticField(REDapp::JavaClassDef& cls, const std::string& name, const std::string& sig);
-	jfieldID GetStaticField(jclass cls, const std::string& clsname, const std::string& name, const std::string& sig);
-	jfieldID GetField(REDapp::JavaClassDef& cls, const std::string& name, const std::string& sig);
-	jfieldID GetField(jclass cls, const std::string& clsname, const std::string& name, const std::string& sig);
-	jobject GetStaticObjectField(jclass cls, jfieldID fid);
-	jobject CallStaticObjectMethod(jclass cls, jmethodID mid, jobject param);
-	jobject CallStaticObjectMethod(jclass cls, jmethodID mid, jint param);
-	jboolean CallStaticBooleanMethod(jclass cls, jmethodID mid, jobject param);
-	jobject CallObjectMethodO(jobject obj, jmethodID mid, jobject o);
-	jobject CallObjectMethodOO(jobject obj, jmethodID mid, jobject o1, jobject o2);
-	jobject CallObjectMethodOOI(jobject obj, jmethodID mid, jobject o1, jobject o2, jint i1);
-	jobject CallObjectMethod(jobject obj, jmethodID mid, jint ind);
-	jdouble CallDoubleMethod(jobject obj, jmethodID mid, ...);
-	jdouble CallObjectDoubleMethod(jobject obj, jmethodID mid, ...);
-	jboolean CallBooleanMethod(jobject obj, jmethodID mid);
-	jboolean CallBooleanMethod(jobject obj, jmethodID mid, int param);
-	jint CallIntegerMethod(jobject obj, jmethodID mid);
-	jint CallIntegerMethod(jobject obj, jmethodID mid, jint param);
-	jlong CallLongMethod(jobject obj, jmethodID mid);
-	void CallMethod(jobject obj, jmethodID mid, jobject param);
-	void CallMethod(jobject obj, jmethodID mid, jint param);
-	void CallMethod(jobject obj, jmethodID mid, jint param1, jint param2);
-	void CallMethod(jobject obj, jmethodID mid, jdouble param);
-	void CallMethod(jobject obj, jmethodID mid, jlong param);
-	jobject NewObject(jclass cls, jmethodID constructor, jobject param);
-	jobject NewObject(jclass cls, jmethodID constructor, jlong lval);
+	explicit ResumerPool(size_t count) {
+		count = std::max<size_t>(count, 1);
+		m_threads.reserve(count);
+		for (size_t i = 0; i < count; i++)
+			m_threads.emplace_back([this] { Entry(); });
+	}
 
-	void DeleteObject(jobject obj);
+	~ResumerPool() {
+		{
+			std::lock_guard<std::mutex> l(m_lock);
+			m_exit = true;
+		}
+		m_cv.notify_all();
+		for (std::thread& t : m_threads)
+			t.join();
+	}
+
+	void post(std::coroutine_handle<> handle) {
+		{
+			std::lock_guard<std::mutex> l(m_lock);
+			m_handles.push_back(handle);
+		}
+		m_cv.notify_one();
+	}
 
-	jobject CallObjectField(jobject obj, jfieldID fid);
-	jint CallIntField(jobject obj, jfieldID fid);
-	jdouble CallDoubleField(jobject obj, jfieldID fid);
-	jlong CallLongField(jobject obj, jfieldID fid);
+private:
+	void Entry() {
+		std::unique_lock<std::mutex> l(m_lock);
+		for (;;) {
+			m_cv.wait(l, [this] { return m_exit || !m_handles.empty(); });
+			if (m_handles.empty())
+				return;
+			std::coroutine_handle<> handle = m_handles.front();
+			m_handles.pop_front();
+			l.unlock();
+			handle.resume();
+			l.lock();
+		}
+	}
 
-	jintArray NewIntArray(int size);
-	jdoubleArray NewDoubleArray(int size);
-	jobjectArray NewObjectArray(int size, jclass cls);
+private:
+	std::mutex m_lock;
+	std::condition_variable m_cv;
+	std::deque<std::coroutine_handle<>> m_handles;
+	std::vector<std::thread> m_threads;
+	bool m_exit{ false };
+};
 
-	int SetIntField(jobject obj, jfieldID fld, jint val);
-	int SetDoubleField(jobject obj, jfieldID fld, jdouble val);
-	int SetLongField(jobject obj, jfieldID fld, jlong val);
-	int SetObjectField(jobject obj, jfieldID fld, jobject val);
+class REDappWrapperPrivate : public boost::serialization::singleton<REDappWrapperPrivate> {
+public:
+	REDappWrapperPrivate() : m_jvm(nullptr), m_pool(nullptr) { }
+	virtual ~REDappWrapperPrivate();
 
-	jobject GetArrayElement(jobject obj, int* size, int index = -1);
-	int SetObjectArrayElement(jobjectArray arr, int index, jobject val);
+private:
+	/**
+	 * Load Java if it isn't already loaded. Workers never reload Java themselves since that would
+	 * tear down the pool they are running on.
+	 */
+	inline void init() {
+		if (WorkerThread::current() && m_jvm)
+			return;
+		std::lock_guard<std::mutex> lock(m_initLock);
+		if (m_jvm == nullptr || !m_jvm->IsValid())
+			_init();
+	}
+	void _init();
 
-	std::string GetJStringContent(jstring str);
-	jstring GetJString(std::string str);
-	void FreeJString(jstring str);
+public:
+	int run(WorkerThread::job_t& job);
+
+	/**
+	 * Run an arbitrary sequence of JNI calls on the worker thread in a single hand off. The
+	 * callable is passed the worker's NativeJVM and its return value (if any) is passed back
+	 * to the caller. If Java can't be loaded the callable isn't run and a value initialized
+	 * result is returned.
+	 */
+	template<typename _Fn>
+	auto transact(_Fn&& fn) -> std::invoke_result_t<_Fn, NativeJVM&>;
+
+	/**
+	 * Run a transaction on whichever worker in the pool is free first. The callable may only
+	 * use global references (every object held by a JavaObject and every class returned by
+	 * GlobalClass) and local references it creates itself, and any object it returns to the
+	 * caller must be pinned.
+	 */
+	template<typename _Fn>
+	auto transactAny(_Fn&& fn) -> std::invoke_result_t<_Fn, NativeJVM&>;
+
+	/**
+	 * Asynchronous jobs run on the calling thread when it's already a worker, so a caller waiting
+	 * on the result, or a completion callback starting more work, doesn't wait on its own queue,
+	 * or when direct execution is turned on.
+	 */
+	inline bool asyncInline() const { return WorkerThread::current() || m_mode.load(std::memory_order_relaxed) == REDapp::ExecutionMode::DIRECT; }
+
+	/**
+	 * Queue a job on any worker without waiting for it. The job is a plain callable, any calls
+	 * it makes back into the wrapper run inline on the worker that picked it up. If asyncInline()
+	 * the job runs before this returns instead.
+	 * @returns A future for the job's result. If the job throws the exception is stored in the future.
+	 */
+	template<typename _Fn>
+	auto async(_Fn fn) -> std::future<std::invoke_result_t<_Fn&>>;
+
+	/**
+	 * Queue a job on any worker and hand its result to a callback on that worker once it has
+	 * completed. The callback is passed a ready future so exceptions can be collected with get(),
+	 * anything the callback itself throws is discarded. If asyncInline() the job and the callback
+	 * both run on the calling thread before this returns.
+	 */
+	template<typename _Fn, typename _Cb>
+	void async(_Fn fn, _Cb callback);
+
+	/**
+	 * Look up a class from within a transaction. The class is cached as a global reference.
+	 */
+	jclass GlobalClass(NativeJVM& jvm, const char* name);
+
+	/**
+	 * Classes and members from the registry. They are resolved once when Java is loaded so these
+	 * are plain array lookups, and are only valid while Java is.
+	 */
+	inline jclass Class(JavaRegistry::Class id) const { return m_classes[(size_t)id]; }
+	inline jmethodID Method(JavaRegistry::Member id) const { return m_members[(size_t)id].method; }
+	inline jfieldID Field(JavaRegistry::Member id) const { return m_members[(size_t)id].field; }
+	inline jobject Constant(JavaRegistry::Member id) const { return m_members[(size_t)id].constant; }
+	/**
+	 * The UTC time zone, so native calendars can be converted to Java ones without looking it up each time.
+	 */
+	inline jobject UtcTimeZone() const { return m_utc; }
+	inline jclass GlobalClass(NativeJVM& jvm, const std::string& name) { return GlobalClass(jvm, name.c_str()); }
+
+	/**
+	 * Look up a method or field ID from within a transaction. The class must be a global
+	 * reference, the ID is cached until Java is reloaded.
+	 */
+	jmethodID Method(NativeJVM& jvm, jclass cls, const char* name, const char* sig);
+	jmethodID StaticMethod(NativeJVM& jvm, jclass cls, const char* name, const char* sig);
+	jfieldID Field(NativeJVM& jvm, jclass cls, const char* name, const char* sig);
+	jfieldID StaticField(NativeJVM& jvm, jclass cls, const char* name, const char* sig);
+
+	REDapp::CacheStatistics CacheStatistics();
+
+	/**
+	 * Counters for imports made with the native hourly parser enabled.
+	 */
+	struct import_counters {
+		std::atomic<std::uint64_t> nativeImports{ 0 };
+		std::atomic<std::uint64_t> javaFallbacks{ 0 };
+		std::atomic<std::uint64_t> verified{ 0 };
+		std::atomic<std::uint64_t> mismatches{ 0 };
+		/**
+		 * Whether the native parser has been checked against Java yet in this process, and
+		 * whether it matched.
+		 */
+		enum conformance_t { UNCHECKED, CONFORMS, DIFFERS };
+		std::atomic<conformance_t> conformance{ UNCHECKED };
+	};
+	inline import_counters& ImportCounters() { return m_importCounters; }
+
+	/**
+	 * Counters for interpolations made with the native spline enabled.
+	 */
+	struct spline_counters {
+		std::atomic<std::uint64_t> nativeFits{ 0 };
+		std::atomic<std::uint64_t> javaFallbacks{ 0 };
+		std::atomic<std::uint64_t> verified{ 0 };
+		std::atomic<std::uint64_t> mismatches{ 0 };
+	};
+	inline spline_counters& SplineCounters() { return m_splineCounters; }
+
+	inline ForecastCache& Forecasts() { return m_forecasts; }
+
+	/**
+	 * Swap a local reference for a global one so it can be used from any worker. Must be called
+	 * from within a transaction.
+	 */
+	static jobject Pin(NativeJVM& jvm, jobject local);
+
+	/**
+	 * Set the number of worker threads to use the next time Java is initialized.
+	 */
+	inline void SetWorkerCount(size_t count) { m_workerCount = std::max<size_t>(count, 1); }
+	inline size_t WorkerCount() const { return m_workerCount; }
+	/**
+	 * The number of workers in the running pool. This can differ from WorkerCount if the count
+	 * was changed after Java loaded or if Java failed to load. Always at least one.
+	 */
+	inline size_t PoolSize() const { return m_pool ? std::max<size_t>(m_pool->size(), 1) : 1; }
+
+	/**
+	 * Whether data is copied out of Java in bulk through the wrapper's Java adapter when it's loaded.
+	 */
+	inline void SetBulkTransfers(bool enabled) { m_bulk.store(enabled, std::memory_order_relaxed); }
+	inline bool BulkTransfers() const { return m_bulk.load(std::memory_order_relaxed); }
+
+	inline void SetExecutionMode(REDapp::ExecutionMode mode) { m_mode.store(mode, std::memory_order_relaxed); }
+	inline REDapp::ExecutionMode Mode() const { return m_mode.load(std::memory_order_relaxed); }
+
+	/**
+	 * The memory resource to allocate results from. Uses the given resource if there is one,
+	 * otherwise the library wide resource.
+	 */
+	inline void SetMemoryResource(std::pmr::memory_resource* resource) { m_resource.store(resource, std::memory_order_relaxed); }
+	inline std::pmr::memory_resource* MemoryResource(std::pmr::memory_resource* resource = nullptr) const {
+		if (resource)
+			return resource;
+		resource = m_resource.load(std::memory_order_relaxed);
+		return resource ? resource : std::pmr::get_default_resource();
+	}
+
+	/**
+	 * The number of jobs that have been handed to the worker thread.
+	 */
+	inline std::uint64_t HopCount() const { return m_hops.load(std::memory_order_relaxed); }
+
+	REDapp::WorkerStatistics Statistics();
+
+	/**
+	 * Resume a coroutine on the shared resumer threads, starting them the first time.
+	 */
+	void Resume(std::coroutine_handle<> handle);
 
-	jboolean ExceptionCheck();
+	void DeleteObject(jobject obj);
 
 	inline bool Valid(bool reInitIfPossible) { if (!m_jvm || reInitIfPossible) init(); return m_jvm && m_jvm->IsValid(); }
 	inline unsigned long LoadError() { if (!m_jvm) init(); if (m_jvm->GetError()) return m_jvm->GetError(); return m_jvm->GetLoadError(); }
 	inline std::string ErrorDescription() { if (!m_jvm) init(); return m_jvm->GetErrorDescription(); }
-	inline std::string DetailedError() { if (!m_jvm) init(); return m_jvm->GetDetailedError(); }
+	inline std::string DetailedError() { if (!m_jvm) init(); return m_jvm->GetDetailedError() + m_registryErrors; }
 	inline std::string JavaPath() { init(); return m_jvm->GetJavaPath(); }
 	inline std::string JavaVersion() { init(); return m_jvm->GetJavaVersion(); }
 
 	void SetPathOverride(const std::string& path) { m_overridePath = path; }
 
-public:
-	jobject NativeProvinceToJava(REDapp::Province prov);
-	jobject NativeModelToJava(REDapp::Model mod);
-	jobject NativeTimeToJava(REDapp::Time tim);
-
 private:
+	bool runInline();
+	void resolveRegistry();
+
+	union resolved_member {
+		jmethodID method;
+		jfieldID field;
+		jobject constant;
+	};
+
 	std::string m_overridePath;
 	std::unique_ptr<NativeJVM> m_jvm;
-	REDappWrapperCache_class m_classCache;
-	REDappWrapperCache_method m_methodCache;
-	REDappWrapperCache_field m_fieldCache;
-	WorkerThread *m_thread;
-	std::mutex m_locker;
+	JavaIDCache<jclass> m_classCache;
+	JavaIDCache<jmethodID> m_methodCache;
+	JavaIDCache<jmethodID> m_staticMethodCache;
+	JavaIDCache<jfieldID> m_fieldCache;
+	JavaIDCache<jfieldID> m_staticFieldCache;
+	jclass m_classes[JavaRegistry::ClassCount]{};
+	resolved_member m_members[JavaRegistry::MemberCount]{};
+	jobject m_utc{ nullptr };
+	std::string m_registryErrors;
+	WorkerPool *m_pool;
+	std::atomic<size_t> m_workerCount{ 1 };
+	std::atomic<REDapp::ExecutionMode> m_mode{ REDapp::ExecutionMode::WORKER };
+	std::atomic<bool> m_bulk{ true };
+	std::atomic<std::pmr::memory_resource*> m_resource{ nullptr };
 	std::mutex m_initLock;
+	std::atomic<std::uint64_t> m_hops{ 0 };
+	import_counters m_importCounters;
+	spline_counters m_splineCounters;
+	ForecastCache m_forecasts;
+	std::once_flag m_resumerOnce;
+	std::unique_ptr<ResumerPool> m_resumer;
 };
 
-int REDappWrapperPrivate::run(WorkerThread::job_t job) {
-	std::lock_guard<std::mutex> lock(m_locker);
-	m_thread->runJob(job);
+/**
+ * Jobs run on the calling thread when the caller is already a worker, so a job that calls back
+ * into the wrapper doesn't wait on itself, or when direct execution is turned on. Direct callers
+ * are attached to Java as daemon threads the first time they call in.
+ */
+bool REDappWrapperPrivate::runInline() {
+	if (WorkerThread::current())
+		return true;
+	if (m_mode.load(std::memory_order_relaxed) == REDapp::ExecutionMode::DIRECT)
+		return m_jvm->AttachCurrentThreadAsDaemon();
+	return false;
+}
+
+int REDappWrapperPrivate::run(WorkerThread::job_t& job) {
+	if (runInline()) {
+		job();
+		return 0;
+	}
+	m_hops.fetch_add(1, std::memory_order_relaxed);
+	m_pool->primary()->runJob(job);
 
 	return 0;
 }
 
+jclass REDappWrapperPrivate::GlobalClass(NativeJVM& jvm, const char* name) {
+	return m_classCache.get(nullptr, name, "", [&jvm, name]() -> jclass {
+		jclass local = jvm.FindClass(name);
+		if (!local)
+			return nullptr;
+		jclass global = (jclass)jvm.NewGlobalRef(local);
+		jvm.DeleteLocalRef(local);
+		return global;
+	});
+}
 
-#define STANDARD_STRING_GETTER(cls, var) \
-	const std::string cls::var() \
-	{ \
-		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance(); \
-		jmethodID mid = priv.GetMethod(_type, "get"#var, "()Ljava/lang/String;"); \
-		return priv.GetJStringContent((jstring)priv.CallObjectMethodO((jobject)_internal, mid, nullptr)); \
-	}
-#define STANDARD_DOUBLE_GETTER(cls, var) \
-	double cls::var() \
-	{ \
-		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance(); \
-		jmethodID mid = priv.GetMethod(_type, "get"#var, "()Ljava/lang/Double;"); \
-		return priv.CallObjectDoubleMethod((jobject)_internal, mid); \
-	}
-#define JAVA_INTEGER_GETTER(cls, var) \
-	int cls::get ## var() \
-	{ \
-		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance(); \
-		jmethodID mid = priv.GetMethod(_type, "get"#var, "()I"); \
-		return priv.CallIntegerMethod((jclass)_internal, mid); \
-	}
-#define STANDARD_STRING_FIELD(cls, var) \
-	const std::string cls::var() \
-	{ \
-		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance(); \
-		jfieldID fid = priv.GetField(_type, std::string(#var), std::string("Ljava/lang/String;")); \
-		return priv.GetJStringContent((jstring)priv.CallObjectField((jobject)_internal, fid)); \
-	}
-#define STANDARD_INTEGER_SETTER(cls, var) \
-	void cls::set ## var(int val) \
-	{ \
-		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance(); \
-		jmethodID mid = priv.GetMethod(_type, std::string("set"#var), std::string("(I)V")); \
-		priv.CallMethod((jobject)_internal, mid, val); \
+/**
+ * Look up every class and member in the registry. Anything required that can't be found is
+ * added to the detailed error so a mismatched Java library is reported when Java loads instead
+ * of showing up as a null ID part way through a call.
+ */
+void REDappWrapperPrivate::resolveRegistry() {
+	m_registryErrors.clear();
+	for (size_t i = 0; i < JavaRegistry::ClassCount; i++) {
+		const JavaRegistry::ClassEntry& entry = JavaRegistry::Classes[i];
+		m_classes[i] = GlobalClass(*m_jvm, entry.name);
+		if (!m_classes[i]) {
+			m_jvm->ExceptionClear();
+			if (!entry.optional)
+				m_registryErrors += std::string("\nMissing Java class ") + entry.name;
+		}
 	}
 
+	for (size_t i = 0; i < JavaRegistry::MemberCount; i++) {
+		const JavaRegistry::MemberEntry& entry = JavaRegistry::Members[i];
+		jclass cls = m_classes[(size_t)entry.cls];
+		bool found = false;
+		m_members[i] = resolved_member{};
+		if (cls) {
+			switch (entry.kind) {
+			case JavaRegistry::MemberKind::METHOD:
+				m_members[i].method = Method(*m_jvm, cls, entry.name, entry.signature);
+				found = m_members[i].method != nullptr;
+				break;
+			case JavaRegistry::MemberKind::STATIC_METHOD:
+				m_members[i].method = StaticMethod(*m_jvm, cls, entry.name, entry.signature);
+				found = m_members[i].method != nullptr;
+				break;
+			case JavaRegistry::MemberKind::FIELD:
+				m_members[i].field = Field(*m_jvm, cls, entry.name, entry.signature);
+				found = m_members[i].field != nullptr;
+				break;
+			case JavaRegistry::MemberKind::STATIC_FIELD:
+				m_members[i].field = StaticField(*m_jvm, cls, entry.name, entry.signature);
+				found = m_members[i].field != nullptr;
+				break;
+			default:
+				{
+					jfieldID fid = StaticField(*m_jvm, cls, entry.name, entry.signature);
+					if (fid)
+						m_members[i].constant = Pin(*m_jvm, m_jvm->GetStaticObjectField(cls, fid));
+					found = m_members[i].constant != nullptr;
+				}
+				break;
+			}
+		}
+		if (!found) {
+			m_jvm->ExceptionClear();
+			if (!entry.optional)
+				m_registryErrors += std::string("\nMissing Java member ") + JavaRegistry::Classes[(size_t)entry.cls].name + "." + entry.name + entry.signature;
+		}
+	}
 
-namespace REDapp {
-REDappWrapper::REDappWrapper() {
-	Initialize();
+	m_utc = nullptr;
+	jmethodID getTimeZone = Method(JavaRegistry::Member::TimeZone_getTimeZone);
+	if (getTimeZone) {
+		jstring utc = m_jvm->NewStringUTF("UTC");
+		m_utc = Pin(*m_jvm, m_jvm->CallStaticObjectMethod(Class(JavaRegistry::Class::TimeZone), getTimeZone, utc));
+		m_jvm->DeleteLocalRef(utc);
+	}
 }
 
-REDappWrapper::REDappWrapper(const REDappWrapper& toCopy) {
+jmethodID REDappWrapperPrivate::Method(NativeJVM& jvm, jclass cls, const char* name, const char* sig) {
+	return m_methodCache.get(cls, name, sig, [&]() { return jvm.GetMethodID(cls, name, sig); });
 }
 
-REDappWrapper& REDappWrapper::operator=(const REDappWrapper& toCopy) {
-	return *this;
+jmethodID REDappWrapperPrivate::StaticMethod(NativeJVM& jvm, jclass cls, const char* name, const char* sig) {
+	return m_staticMethodCache.get(cls, name, sig, [&]() { return jvm.GetStaticMethodID(cls, name, sig); });
 }
 
-bool REDappWrapper::CanLoadJava(bool reInitIfPossible) {
-	return REDappWrapperPrivate::get_mutable_instance().Valid(reInitIfPossible);
+jfieldID REDappWrapperPrivate::Field(NativeJVM& jvm, jclass cls, const char* name, const char* sig) {
+	return m_fieldCache.get(cls, name, sig, [&]() { return jvm.GetFieldID(cls, name, sig); });
 }
 
-unsigned long REDappWrapper::JavaLoadError() {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	return priv.LoadError();
+jfieldID REDappWrapperPrivate::StaticField(NativeJVM& jvm, jclass cls, const char* name, const char* sig) {
+	return m_staticFieldCache.get(cls, name, sig, [&]() { return jvm.GetStaticFieldID(cls, name, sig); });
 }
 
-std::string REDappWrapper::GetErrorDescription() {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	return priv.ErrorDescription();
+REDapp::CacheStatistics REDappWrapperPrivate::CacheStatistics() {
+	REDapp::CacheStatistics stats{};
+	stats.classHits = m_classCache.hits();
+	stats.classMisses = m_classCache.misses();
+	stats.methodHits = m_methodCache.hits() + m_staticMethodCache.hits();
+	stats.methodMisses = m_methodCache.misses() + m_staticMethodCache.misses();
+	stats.fieldHits = m_fieldCache.hits() + m_staticFieldCache.hits();
+	stats.fieldMisses = m_fieldCache.misses() + m_staticFieldCache.misses();
+	return stats;
 }
 
-std::string REDappWrapper::GetDetailedError() {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	return priv.DetailedError();
+void REDappWrapperPrivate::Resume(std::coroutine_handle<> handle) {
+	std::call_once(m_resumerOnce, [this] {
+		m_resumer = std::make_unique<ResumerPool>(std::max(std::thread::hardware_concurrency(), 1u));
+	});
+	m_resumer->post(handle);
 }
 
-std::string REDappWrapper::GetJavaPath() {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	return priv.JavaPath();
+void REDapp::ResumeCoroutine(std::coroutine_handle<> handle) {
+	REDappWrapperPrivate::get_mutable_instance().Resume(handle);
 }
 
-std::string REDappWrapper::GetJavaVersion() {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	return priv.JavaVersion();
+REDapp::WorkerStatistics REDappWrapperPrivate::Statistics() {
+	REDapp::WorkerStatistics stats{};
+	if (m_pool)
+		m_pool->statistics(stats);
+	return stats;
 }
 
-bool REDappWrapper::InternetDetected() {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jclass WebDownloader = priv.GetClass("ca/hss/general/WebDownloader");
-	jmethodID hasInternetConnection = priv.GetStaticMethod(WebDownloader, "ca/hss/general/WebDownloader", std::string("hasInternetConnection"), std::string("()Z"));
-	return priv.CallStaticBooleanMethod(WebDownloader, hasInternetConnection, nullptr) ? true : false;
+jobject REDappWrapperPrivate::Pin(NativeJVM& jvm, jobject local) {
+	if (!local)
+		return nullptr;
+	jobject retval = jvm.NewGlobalRef(local);
+	jvm.DeleteLocalRef(local);
+	return retval;
 }
 
-void REDappWrapper::SetPathOverride(const std::string& path) {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	priv.SetPathOverride(path);
+template<typename _Fn>
+auto REDappWrapperPrivate::transact(_Fn&& fn) -> std::invoke_result_t<_Fn, NativeJVM&> {
+	typedef std::invoke_result_t<_Fn, NativeJVM&> result_t;
+	init();
+	if constexpr (std::is_void_v<result_t>) {
+		if (m_jvm->IsValid()) {
+			WorkerThread::job_t job = [&fn, this] {
+				fn(*m_jvm);
+			};
+			run(job);
+		}
+	}
+	else {
+		result_t retval{};
+		if (m_jvm->IsValid()) {
+			WorkerThread::job_t job = [&retval, &fn, this] {
+				retval = fn(*m_jvm);
+			};
+			run(job);
+		}
+		return retval;
+	}
 }
 
-void REDappWrapper::Initialize() {
-	if (InternetDetected()) {
-		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-		jclass Calculator = priv.GetClass("ca/weather/acheron/Calculator");
-		jmethodID getLocations = priv.GetStaticMethod(Calculator, "ca/weather/acheron/Calculator", std::string("getLocations"), std::string("()Ljava/util/List;"));
-		priv.CallStaticObjectMethod(Calculator, getLocations, nullptr);
+template<typename _Fn>
+auto REDappWrapperPrivate::transactAny(_Fn&& fn) -> std::invoke_result_t<_Fn, NativeJVM&> {
+	typedef std::invoke_result_t<_Fn, NativeJVM&> result_t;
+	init();
+	if constexpr (std::is_void_v<result_t>) {
+		if (m_jvm->IsValid()) {
+			if (runInline())
+				fn(*m_jvm);
+			else {
+				m_hops.fetch_add(1, std::memory_order_relaxed);
+				WorkerThread::completion done;
+				m_pool->submit([&fn, this] {
+					fn(*m_jvm);
+				}, &done);
+				done.wait();
+			}
+		}
+	}
+	else {
+		result_t retval{};
+		if (m_jvm->IsValid()) {
+			if (runInline())
+				retval = fn(*m_jvm);
+			else {
+				m_hops.fetch_add(1, std::memory_order_relaxed);
+				WorkerThread::completion done;
+				m_pool->submit([&retval, &fn, this] {
+					retval = fn(*m_jvm);
+				}, &done);
+				done.wait();
+			}
+		}
+		return retval;
 	}
 }
 
-std::vector<Cities> REDappWrapper::getCities(Province prov) {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jobject jprov = priv.NativeProvinceToJava(prov);
-	jclass citiesHelper = priv.GetClass("ca/weather/current/Cities/CitiesHelper");
-	jmethodID getCities = priv.GetStaticMethod(citiesHelper, "ca/weather/current/Cities/CitiesHelper", std::string("getCities"), std::string("(Lca/weather/forecast/Province;)[Lca/weather/current/Cities/Cities;"));
-	jobjectArray citylist = (jobjectArray)priv.CallStaticObjectMethod(citiesHelper, getCities, jprov);
-	jclass cities = priv.GetClass("ca/weather/current/Cities/Cities");
-	jmethodID getName = priv.GetMethod(cities, "ca/weather/current/Cities/Cities", std::string("getName"), std::string("()Ljava/lang/String;"));
-	int length;
-	priv.GetArrayElement(citylist, &length);
-	std::vector<Cities> list;
-	for (int i = 0; i < length; i++) {
-		jobject j = priv.GetArrayElement(citylist, NULL, i);
-		jobject t = priv.CallObjectMethodO(j, getName, nullptr);
-		list.push_back(Cities(priv.GetJStringContent((jstring)t), (void*)j));
+/**
+ * Run a job and store its result or exception in a promise.
+ */
+template<typename _Result, typename _Fn>
+static void Settle(std::promise<_Result>& promise, _Fn& fn) {
+	try {
+		if constexpr (std::is_void_v<_Result>) {
+			fn();
+			promise.set_value();
+		}
+		else
+			promise.set_value(fn());
+	}
+	catch (...) {
+		promise.set_exception(std::current_exception());
 	}
-	return list;
 }
 
-
-Interpolator::Interpolator()
-	: JavaObject(0, JavaClassDef()) {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	JavaClassDef def = { priv.GetClass("ca/weather/acheron/Interpolator"), "ca/weather/acheron/Interpolator" };
-	_type = def;
-	jmethodID mid = priv.GetMethod(_type, std::string("<init>"), std::string("()V"));
-	_internal = priv.NewObject((jclass)_type.data, mid, nullptr);
+template<typename _Fn>
+auto REDappWrapperPrivate::async(_Fn fn) -> std::future<std::invoke_result_t<_Fn&>> {
+	typedef std::invoke_result_t<_Fn&> result_t;
+	struct task {
+		std::promise<result_t> promise;
+		_Fn fn;
+	};
+	init();
+	if (asyncInline()) {
+		std::promise<result_t> promise;
+		Settle(promise, fn);
+		return promise.get_future();
+	}
+	//asynchronous jobs outlive the caller so their state is boxed rather than stored in the job
+	auto t = std::make_unique<task>(task{ std::promise<result_t>(), std::move(fn) });
+	std::future<result_t> retval = t->promise.get_future();
+	m_hops.fetch_add(1, std::memory_order_relaxed);
+	m_pool->submit([t = std::move(t)] {
+		Settle(t->promise, t->fn);
+	});
+	return retval;
 }
 
-std::vector<std::pair<int, double>> Interpolator::SplineInterpolate(double* houroffsets, double* values, int size) {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jintArray iarr = priv.NewIntArray(size);
-	jclass hourvaluescls = priv.GetClass(std::string("ca/weather/acheron/Interpolator$HourValue"));
-	jmethodID hourvaluesconst = priv.GetMethod(hourvaluescls, std::string("ca/weather/acheron/Interpolator$HourValue"), std::string("<init>"), std::string("()V"));
-	jfieldID houroffsetfld = priv.GetField(hourvaluescls, std::string("ca/weather/acheron/Interpolator$HourValue"), std::string("houroffset"), std::string("D"));
-	jfieldID valuefld = priv.GetField(hourvaluescls, std::string("ca/weather/acheron/Interpolator$HourValue"), std::string("value"), std::string("D"));
-	jobjectArray oarr = priv.NewObjectArray(size, hourvaluescls);
-	for (int i = 0; i < size; i++) {
-		jobject obj = priv.NewObject(hourvaluescls, hourvaluesconst, nullptr);
-		priv.SetDoubleField(obj, houroffsetfld, houroffsets[i]);
-		priv.SetDoubleField(obj, valuefld, values[i]);
-		priv.SetObjectArrayElement(oarr, i, obj);
-		priv.DeleteObject(obj);
-	}
+template<typename _Fn, typename _Cb>
+void REDappWrapperPrivate::async(_Fn fn, _Cb callback) {
+	typedef std::invoke_result_t<_Fn&> result_t;
+	struct task {
+		_Fn fn;
+		_Cb callback;
+	};
+	init();
+	if (asyncInline()) {
+		std::promise<result_t> promise;
+		Settle(promise, fn);
+		try {
+			callback(promise.get_future());
+		}
+		catch (...) {
+		}
+		return;
+	}
+	auto t = std::make_unique<task>(task{ std::move(fn), std::move(callback) });
+	m_hops.fetch_add(1, std::memory_order_relaxed);
+	m_pool->submit([t = std::move(t)] {
+		std::promise<result_t> promise;
+		Settle(promise, t->fn);
+		try {
+			t->callback(promise.get_future());
+		}
+		catch (...) {
+		}
+	});
+}
 
-	jmethodID splineint = priv.GetMethod(_type, std::string("splineInterpolate"), std::string("([Lca/weather/acheron/Interpolator$HourValue;)[Lca/weather/acheron/Interpolator$HourValue;"));
-	jobjectArray retarr = (jobjectArray)priv.CallObjectMethodO((jobject)_internal, splineint, oarr);
+/**
+ * Look up the Java enum constant for a native enum value. Must be called from within a transaction.
+ */
+static jobject ModelToJava(REDapp::Model mod);
+static jobject TimeToJava(REDapp::Time tim);
+static jobject ProvinceToJava(REDapp::Province prov);
 
-	std::vector<std::pair<int, double>> ret;
-	int len;
-	priv.GetArrayElement(retarr, &len);
-	for (int i = 0; i < len; i++) {
-		jobject v = priv.GetArrayElement(retarr, nullptr, i);
-		std::pair<int, double> val;
-		val.first = priv.CallDoubleField(v, houroffsetfld);
-		val.second = priv.CallDoubleField(v, valuefld);
-		ret.push_back(val);
+/**
+ * Copy the contents of a Java string. Must be called from within a transaction.
+ */
+static std::string JStringContent(NativeJVM& jvm, jstring str) {
+	std::string retval;
+	if (str) {
+		const char* s = jvm.GetStringUTFChars(str);
+		retval = s;
+		jvm.ReleaseStringUTFChars(str, s);
 	}
+	return retval;
+}
 
-	return ret;
+/**
+ * Unbox a java.lang.Double, returning infinity for null. Deletes the local reference.
+ */
+static double JDoubleContent(NativeJVM& jvm, jobject boxed) {
+	if (!boxed)
+		return std::numeric_limits<double>::infinity();
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	double retval = jvm.CallDoubleMethod(boxed, priv.Method(JavaRegistry::Member::Double_doubleValue));
+	jvm.DeleteLocalRef(boxed);
+	return retval;
 }
 
 
-std::vector<LocationSmall> ForecastCalculator::getForecastCities(Province prov) {
-	if (REDappWrapper::InternetDetected()) {
-		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-		jclass Calculator = priv.GetClass("ca/weather/acheron/Calculator");
-		jobject province = priv.NativeProvinceToJava(prov);
-		jmethodID getLocations = priv.GetStaticMethod(Calculator, "ca/weather/acheron/Calculator", std::string("getLocations"), std::string("(Lca/weather/forecast/Province;)Ljava/util/List;"));
-		jobject list = priv.CallStaticObjectMethod(Calculator, getLocations, province);
-		jclass List = priv.GetClass("java/util/List");
-		jmethodID size = priv.GetMethod(List, "java/util/List", std::string("size"), std::string("()I"));
-		jmethodID get = priv.GetMethod(List, "java/util/List", std::string("get"), std::string("(I)Ljava/lang/Object;"));
-		jclass LocationSmallClass = priv.GetClass("ca/weather/acheron/Calculator$LocationSmall");
-		int s = priv.CallIntegerMethod(list, size);
-		std::vector<LocationSmall> retval;
-		JavaClassDef def = { LocationSmallClass, "ca/weather/acheron/Calculator$LocationSmall" };
-		for (int i = 0; i < s; i++) {
-			jobject ind = priv.CallObjectMethod(list, get, i);
-			LocationSmall loc(ind, def);
-			retval.push_back(loc);
-		}
-		return retval;
+#define STANDARD_STRING_GETTER(cls, jcls, var) \
+	const std::string cls::var() \
+	{ \
+		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance(); \
+		return priv.transact([this, &priv](NativeJVM& jvm) { \
+			jstring str = (jstring)jvm.CallObjectMethodO((jobject)_internal, priv.Method(JavaRegistry::Member::jcls ## _get ## var), nullptr); \
+			std::string retval = JStringContent(jvm, str); \
+			jvm.DeleteLocalRef(str); \
+			return retval; \
+		}); \
+	}
+#define STANDARD_DOUBLE_GETTER(cls, jcls, var) \
+	double cls::var() \
+	{ \
+		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance(); \
+		return priv.transact([this, &priv](NativeJVM& jvm) { \
+			return JDoubleContent(jvm, jvm.CallObjectMethodO((jobject)_internal, priv.Method(JavaRegistry::Member::jcls ## _get ## var), nullptr)); \
+		}); \
 	}
-	return std::vector<LocationSmall>();
+#define STANDARD_STRING_FIELD(cls, jcls, var) \
+	const std::string cls::var() \
+	{ \
+		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance(); \
+		return priv.transact([this, &priv](NativeJVM& jvm) { \
+			jstring str = (jstring)jvm.GetObjectField((jobject)_internal, priv.Field(JavaRegistry::Member::jcls ## _ ## var)); \
+			std::string retval = JStringContent(jvm, str); \
+			jvm.DeleteLocalRef(str); \
+			return retval; \
+		}); \
+	}
+
+
+WeatherSeriesView WeatherSeriesView::subview(std::size_t offset, std::size_t count) const {
+	WeatherSeriesView retval;
+	offset = std::min(offset, size());
+	count = std::min(count, size() - offset);
+	retval.hour = hour.subspan(offset, count);
+	retval.epoch = epoch.subspan(offset, count);
+	retval.temp = temp.subspan(offset, count);
+	retval.rh = rh.subspan(offset, count);
+	retval.wd = wd.subspan(offset, count);
+	retval.ws = ws.subspan(offset, count);
+	retval.wg = wg.subspan(offset, count);
+	retval.precip = precip.subspan(offset, count);
+	retval.ffmc = ffmc.subspan(offset, count);
+	retval.DMC = DMC.subspan(offset, count);
+	retval.DC = DC.subspan(offset, count);
+	retval.BUI = BUI.subspan(offset, count);
+	retval.ISI = ISI.subspan(offset, count);
+	retval.FWI = FWI.subspan(offset, count);
+	retval.options = options.subspan(offset, count);
+	return retval;
 }
 
-GCWeather REDappWrapper::getGCWeather(Cities city) {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jclass CurrentWeather = priv.GetClass("ca/weather/current/CurrentWeather");
-	jmethodID CurrentWeatherInit = priv.GetMethod(CurrentWeather, "ca/weather/current/CurrentWeather", "<init>", "(Lca/weather/current/Cities/Cities;)V");
-	jobject weather = priv.NewObject(CurrentWeather, CurrentWeatherInit, (jobject)city._internal);
-	JavaClassDef def = { CurrentWeather, "ca/weather/current/CurrentWeather" };
-	return GCWeather((void*)weather, def);
+/**
+ * The memory resource to allocate results from, the given one or the library wide one if it is nullptr.
+ */
+static std::pmr::memory_resource* ResultResource(std::pmr::memory_resource* resource) {
+	return REDappWrapperPrivate::get_const_instance().MemoryResource(resource);
+}
+
+WeatherSeries::WeatherSeries(std::pmr::memory_resource* resource)
+	: hour(ResultResource(resource)),
+	epoch(ResultResource(resource)),
+	temp(ResultResource(resource)),
+	rh(ResultResource(resource)),
+	wd(ResultResource(resource)),
+	ws(ResultResource(resource)),
+	wg(ResultResource(resource)),
+	precip(ResultResource(resource)),
+	ffmc(ResultResource(resource)),
+	DMC(ResultResource(resource)),
+	DC(ResultResource(resource)),
+	BUI(ResultResource(resource)),
+	ISI(ResultResource(resource)),
+	FWI(ResultResource(resource)),
+	options(ResultResource(resource)) {
+}
+
+WeatherSeries::WeatherSeries(const WeatherCollection* data, std::size_t size, std::pmr::memory_resource* resource)
+	: WeatherSeries(resource) {
+	resize(size);
+	for (std::size_t i = 0; i < size; i++)
+		set(i, data[i]);
+}
+
+void WeatherSeries::resize(std::size_t size) {
+	WeatherCollection defaults;
+	hour.resize(size, defaults.hour);
+	epoch.resize(size, defaults.epoch);
+	temp.resize(size, defaults.temp);
+	rh.resize(size, defaults.rh);
+	wd.resize(size, defaults.wd);
+	ws.resize(size, defaults.ws);
+	wg.resize(size, defaults.wg);
+	precip.resize(size, defaults.precip);
+	ffmc.resize(size, defaults.ffmc);
+	DMC.resize(size, defaults.DMC);
+	DC.resize(size, defaults.DC);
+	BUI.resize(size, defaults.BUI);
+	ISI.resize(size, defaults.ISI);
+	FWI.resize(size, defaults.FWI);
+	options.resize(size, defaults.options);
+}
+
+void WeatherSeries::clear() {
+	resize(0);
+}
+
+WeatherCollection WeatherSeries::at(std::size_t index) const {
+	WeatherCollection retval;
+	retval.hour = hour[index];
+	retval.epoch = epoch[index];
+	retval.temp = temp[index];
+	retval.rh = rh[index];
+	retval.wd = wd[index];
+	retval.ws = ws[index];
+	retval.wg = wg[index];
+	retval.precip = precip[index];
+	retval.ffmc = ffmc[index];
+	retval.DMC = DMC[index];
+	retval.DC = DC[index];
+	retval.BUI = BUI[index];
+	retval.ISI = ISI[index];
+	retval.FWI = FWI[index];
+	retval.options = options[index];
+	return retval;
 }
 
-enum class CalendarType {
-	ERA = 0,
-	YEAR = 1,
-	MONTH = 2,
-	WEEK_OF_YEAR = 3,
-	WEEK_OF_MONTH = 4,
-	DATE = 5,
-	DAY_OF_MONTH = 5,
-	DAY_OF_YEAR = 6,
-	DAY_OF_WEEK = 7,
-	DAY_OF_WEEK_IN_MONTH = 8,
-	AM_PM = 9,
-	HOUR = 10,
-	HOUR_OF_DAY = 11,
-	MINUTE = 12,
-	SECOND = 13,
-	MILLISECOND = 14,
-	ZONE_OFFSET = 15,
-	DST_OFFSET = 16
-};
+void WeatherSeries::set(std::size_t index, const WeatherCollection& value) {
+	hour[index] = value.hour;
+	epoch[index] = value.epoch;
+	temp[index] = value.temp;
+	rh[index] = value.rh;
+	wd[index] = value.wd;
+	ws[index] = value.ws;
+	wg[index] = value.wg;
+	precip[index] = value.precip;
+	ffmc[index] = value.ffmc;
+	DMC[index] = value.DMC;
+	DC[index] = value.DC;
+	BUI[index] = value.BUI;
+	ISI[index] = value.ISI;
+	FWI[index] = value.FWI;
+	options[index] = value.options;
+}
+
+void WeatherSeries::copyTo(WeatherCollection* data) const {
+	for (std::size_t i = 0; i < size(); i++)
+		data[i] = at(i);
+}
+
+std::vector<WeatherCollection> WeatherSeries::toCollection() const {
+	std::vector<WeatherCollection> retval(size());
+	copyTo(retval.data());
+	return retval;
+}
 
-Calendar::Calendar()
-	: JavaObject(0, JavaClassDef()) {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	JavaClassDef def = { priv.GetClass("java/util/Calendar"), "java/util/Calendar" };
-	_type = def;
-	jmethodID mid = priv.GetStaticMethod(_type, std::string("getInstance"), std::string("()Ljava/util/Calendar;"));
-	_internal = priv.CallStaticObjectMethod((jclass)_type.data, mid, nullptr);
-	mid = priv.GetMethod(_type, std::string("setTimeZone"), std::string("(Ljava/util/TimeZone;)V"));
-	jclass TimeZone = priv.GetClass("java/util/TimeZone");
-	jmethodID getTimeZone = priv.GetStaticMethod(TimeZone, "java/util/TimeZone", std::string("getTimeZone"), std::string("(Ljava/lang/String;)Ljava/util/TimeZone;"));
-	jstring str = priv.GetJString("UTC");
-	jobject timezone = priv.CallStaticObjectMethod(TimeZone, getTimeZone, str);
-	jmethodID setTimeZone = priv.GetMethod(_type, std::string("setTimeZone"), std::string("(Ljava/util/TimeZone;)V"));
-	priv.CallMethod((jobject)_internal, setTimeZone, timezone);
-	priv.FreeJString(str);
+WeatherSeriesView WeatherSeries::view() const {
+	WeatherSeriesView retval;
+	retval.hour = hour;
+	retval.epoch = epoch;
+	retval.temp = temp;
+	retval.rh = rh;
+	retval.wd = wd;
+	retval.ws = ws;
+	retval.wg = wg;
+	retval.precip = precip;
+	retval.ffmc = ffmc;
+	retval.DMC = DMC;
+	retval.DC = DC;
+	retval.BUI = BUI;
+	retval.ISI = ISI;
+	retval.FWI = FWI;
+	retval.options = options;
+	return retval;
 }
 
-void Calendar::setYear(int year) {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("set"), std::string("(II)V"));
-	priv.CallMethod((jobject)_internal, mid, (jint)CalendarType::YEAR, year);
+namespace REDapp {
+REDappWrapper::REDappWrapper() {
+	Initialize();
 }
 
-void Calendar::setMonth(int month) {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("set"), std::string("(II)V"));
-	priv.CallMethod((jobject)_internal, mid, (jint)CalendarType::MONTH, month);
+REDappWrapper::REDappWrapper(const REDappWrapper& toCopy) {
 }
 
-void Calendar::setDay(int day) {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("set"), std::string("(II)V"));
-	priv.CallMethod((jobject)_internal, mid, (jint)CalendarType::DAY_OF_MONTH, day);
+REDappWrapper& REDappWrapper::operator=(const REDappWrapper& toCopy) {
+	return *this;
 }
 
-void Calendar::setHour(int hour) {
-	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("set"), std::string("(II)V"));
-	priv.CallMethod((jobject)_internal, mid, (jint)CalendarType::HOUR_OF_DAY, hour);
+bool REDappWrapper::CanLoadJava(bool reInitIfPossible) {
+	return REDappWrapperPrivate::get_mutable_instance().Valid(reInitIfPossible);
 }
 
-void Calendar::setMinute(int min) {
+unsigned long REDappWrapper::JavaLoadError() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("set"), std::string("(II)V"));
-	priv.CallMethod((jobject)_internal, mid, (jint)CalendarType::MINUTE, min);
+	return priv.LoadError();
 }
 
-void Calendar::setSeconds(int sec) {
+std::string REDappWrapper::GetErrorDescription() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("set"), std::string("(II)V"));
-	priv.CallMethod((jobject)_internal, mid, (jint)CalendarType::SECOND, sec);
+	return priv.ErrorDescription();
 }
 
-int Calendar::getYear() {
+std::string REDappWrapper::GetDetailedError() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("get"), std::string("(I)I"));
-	return priv.CallIntegerMethod((jobject)_internal, mid, (jint)CalendarType::YEAR);
+	return priv.DetailedError();
 }
 
-int Calendar::getMonth() {
+std::string REDappWrapper::GetJavaPath() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("get"), std::string("(I)I"));
-	return priv.CallIntegerMethod((jobject)_internal, mid, (jint)CalendarType::MONTH);
+	return priv.JavaPath();
 }
 
-int Calendar::getDay() {
+std::string REDappWrapper::GetJavaVersion() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("get"), std::string("(I)I"));
-	return priv.CallIntegerMethod((jobject)_internal, mid, (jint)CalendarType::DAY_OF_MONTH);
+	return priv.JavaVersion();
 }
 
-int Calendar::getHour() {
+std::uint64_t REDappWrapper::JavaHopCount() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("get"), std::string("(I)I"));
-	return priv.CallIntegerMethod((jobject)_internal, mid, (jint)CalendarType::HOUR_OF_DAY);
+	return priv.HopCount();
 }
 
-int Calendar::getMinute() {
+WorkerStatistics REDappWrapper::GetWorkerStatistics() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("get"), std::string("(I)I"));
-	return priv.CallIntegerMethod((jobject)_internal, mid, (jint)CalendarType::MINUTE);
+	return priv.Statistics();
 }
 
-int Calendar::getSeconds() {
+CacheStatistics REDappWrapper::GetCacheStatistics() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("get"), std::string("(I)I"));
-	return priv.CallIntegerMethod((jobject)_internal, mid, (jint)CalendarType::SECOND);
+	return priv.CacheStatistics();
 }
 
-std::string Calendar::toString() {
+ImportStatistics REDappWrapper::GetImportStatistics() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jstring format = priv.GetJString(std::string("yyyyMMddHHmmss z"));
-	jmethodID getTimezone = priv.GetMethod(_type, std::string("getTimeZone"), std::string("()Ljava/util/TimeZone;"));
-	jobject tz = priv.CallObjectMethodO((jobject)_internal, getTimezone, nullptr);
-	jclass SimpleDateFormatterCls = priv.GetClass(std::string("java/text/SimpleDateFormat"));
-	jmethodID constr = priv.GetMethod(SimpleDateFormatterCls, std::string("java/text/SimpleDateFormat"), std::string("<init>"), std::string("(Ljava/lang/String;)V"));
-	jobject formatter = priv.NewObject(SimpleDateFormatterCls, constr, format);
-	jmethodID setTimezone = priv.GetMethod(SimpleDateFormatterCls, std::string("java/text/SimpleDateFormat"), std::string("setTimeZone"), std::string("(Ljava/util/TimeZone;)V"));
-	priv.CallMethod(formatter, setTimezone, tz);
-	jmethodID gettime = priv.GetMethod(_type, std::string("getTime"), std::string("()Ljava/util/Date;"));
-	jobject time = priv.CallObjectMethodO((jobject)_internal, gettime, nullptr);
-	jmethodID formatid = priv.GetMethod(SimpleDateFormatterCls, std::string("java/text/SimpleDateFormat"), std::string("format"), std::string("(Ljava/util/Date;)Ljava/lang/String;"));
-	jobject s = priv.CallObjectMethodO(formatter, formatid, time);
-	jstring str = (jstring)s;
-	priv.DeleteObject(formatter);
-	std::string ret = priv.GetJStringContent(str);
-	priv.FreeJString(str);
-	return ret;
+	REDappWrapperPrivate::import_counters& counters = priv.ImportCounters();
+	ImportStatistics stats{};
+	stats.nativeImports = counters.nativeImports.load(std::memory_order_relaxed);
+	stats.javaFallbacks = counters.javaFallbacks.load(std::memory_order_relaxed);
+	stats.verified = counters.verified.load(std::memory_order_relaxed);
+	stats.mismatches = counters.mismatches.load(std::memory_order_relaxed);
+	stats.nativeDisabled = counters.conformance.load(std::memory_order_relaxed) == REDappWrapperPrivate::import_counters::DIFFERS;
+	return stats;
 }
 
-void Calendar::fromString(const std::string& val) {
+void REDappWrapper::SetForecastCache(const ForecastCacheOptions& options) {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jstring format = priv.GetJString(std::string("yyyyMMddHHmmss z"));
-	jstring text = priv.GetJString(val);
-	jclass SimpleDateFormatterCls = priv.GetClass(std::string("java/text/SimpleDateFormat"));
-	jmethodID constr = priv.GetMethod(SimpleDateFormatterCls, std::string("java/text/SimpleDateFormat"), std::string("<init>"), std::string("(Ljava/lang/String;)V"));
-	jobject formatter = priv.NewObject(SimpleDateFormatterCls, constr, format);
-	jmethodID settime = priv.GetMethod(_type, std::string("setTime"), std::string("(Ljava/util/Date;)V"));
-	jmethodID parse = priv.GetMethod(SimpleDateFormatterCls, std::string("java/text/SimpleDateFormat"), std::string("parse"), std::string("(Ljava/lang/String;)Ljava/util/Date;"));
-	jobject date = priv.CallObjectMethodO(formatter, parse, text);
-	priv.CallMethod((jobject)_internal, settime, date);
-	priv.DeleteObject(formatter);
+	priv.Forecasts().configure(options);
 }
 
-JavaWeatherStream::JavaWeatherStream()
-	 : JavaObject(0, JavaClassDef()) {
+ForecastCacheOptions REDappWrapper::GetForecastCache() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	JavaClassDef def = { priv.GetClass("ca/wise/weather/WeatherCondition"), "ca/wise/weather/WeatherCondition" };
-	_type = def;
-	jmethodID mid = priv.GetMethod(_type, std::string("<init>"), std::string("()V"));
-	_internal = priv.NewObject((jclass)_type.data, mid, nullptr);
+	return priv.Forecasts().options();
 }
 
-void JavaObject::dispose() {
+void REDappWrapper::ClearForecastCache() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	if (m_isnew)
-		priv.DeleteObject((jobject)_internal);
-	_internal = nullptr;
+	priv.Forecasts().clear();
 }
 
-void JavaWeatherStream::setLatitude(double latitude) {
+ForecastCacheStatistics REDappWrapper::GetForecastCacheStatistics() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("setLatitude"), std::string("(D)V"));
-	priv.CallMethod((jobject)_internal, mid, latitude);
+	return priv.Forecasts().statistics();
 }
 
-void JavaWeatherStream::setLongitude(double longitude) {
+SplineStatistics REDappWrapper::GetSplineStatistics() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("setLongitude"), std::string("(D)V"));
-	priv.CallMethod((jobject)_internal, mid, longitude);
+	REDappWrapperPrivate::spline_counters& counters = priv.SplineCounters();
+	SplineStatistics stats{};
+	stats.nativeFits = counters.nativeFits.load(std::memory_order_relaxed);
+	stats.javaFallbacks = counters.javaFallbacks.load(std::memory_order_relaxed);
+	stats.verified = counters.verified.load(std::memory_order_relaxed);
+	stats.mismatches = counters.mismatches.load(std::memory_order_relaxed);
+	return stats;
 }
 
-void JavaWeatherStream::setTimezone(int64_t offset) {
+void REDappWrapper::SetExecutionMode(ExecutionMode mode) {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("setTimezone"), std::string("(J)V"));
-	priv.CallMethod((jobject)_internal, mid, offset);
+	priv.SetExecutionMode(mode);
 }
 
-void JavaWeatherStream::setDaylightSavings(int64_t amount) {
+ExecutionMode REDappWrapper::GetExecutionMode() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("setDaylightSavings"), std::string("(J)V"));
-	priv.CallMethod((jobject)_internal, mid, amount);
+	return priv.Mode();
 }
 
-void JavaWeatherStream::setDaylightSavingsStart(int64_t offset) {
+void REDappWrapper::SetBulkTransfers(bool enabled) {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("setDaylightSavingsStart"), std::string("(J)V"));
-	priv.CallMethod((jobject)_internal, mid, offset);
+	priv.SetBulkTransfers(enabled);
 }
 
-void JavaWeatherStream::setDaylightSavingsEnd(int64_t offset) {
+bool REDappWrapper::GetBulkTransfers() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("setDaylightSavingsEnd"), std::string("(J)V"));
-	priv.CallMethod((jobject)_internal, mid, offset);
+	return priv.BulkTransfers();
 }
 
-WeatherCollection* JavaWeatherStream::importHourly(std::string& filename, long* hr, size_t* length) {
+void REDappWrapper::SetMemoryResource(std::pmr::memory_resource* resource) {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	JavaClassDef outvardef = { priv.GetClass("ca/hss/general/OutVariable"), "ca/hss/general/OutVariable" };
-	jmethodID outvarinit = priv.GetMethod(outvardef, std::string("<init>"), std::string("()V"));
-	jobject outvar = priv.NewObject((jclass)outvardef.data, outvarinit, nullptr);
-	jfieldID outvarvalue = priv.GetField(outvardef, std::string("value"), std::string("Ljava/lang/Object;"));
-	jclass longCls = priv.GetClass(std::string("java/lang/Long"));
-	jmethodID longInit = priv.GetMethod(longCls, std::string("java/lang/Long"), std::string("<init>"), std::string("(J)V"));
-	jobject zerol = priv.NewObject(longCls, longInit, (jlong)0);
-	priv.SetObjectField(outvar, outvarvalue, zerol);
-	jstring f = priv.GetJString(filename);
-	jobject retval;
-	jmethodID ihMID = priv.GetMethod(_type, std::string("importHourly"),
-		std::string(JMethodDefinition(JParameter(JTypeString) JObjectParameter(ca/hss/general/OutVariable) JTypeInt, JObjectParameter(java/util/List))));
-	if (ihMID == nullptr) {
-		ihMID = priv.GetMethod(_type, std::string("importHourly"),
-			std::string(JMethodDefinition(JParameter(JTypeString) JObjectParameter(ca/hss/general/OutVariable), JObjectParameter(java/util/List))));
-		retval = priv.CallObjectMethodOO((jobject)_internal, ihMID, f, outvar);
-	}
-	else
-		retval = priv.CallObjectMethodOOI((jobject)_internal, ihMID, f, outvar, (jint)m_allowInvalid);
-	jobject hrjava = priv.CallObjectField(outvar, outvarvalue);
-	jmethodID longGetLong = priv.GetMethod(longCls, std::string("java/lang/Long"), std::string("longValue"), std::string("()J"));
-	*hr = priv.CallLongMethod(hrjava, longGetLong);
-
-	priv.FreeJString(f);
-	priv.DeleteObject(outvar);
-	priv.DeleteObject(zerol);
-
-	if ((*hr == 0) || (*hr == 12803) || (*hr == 12805) || (*hr == (0x80000000 | 13))) {
-		jclass listClass = priv.GetClass(std::string("java/util/List"));
-		jmethodID listSize = priv.GetMethod(listClass, std::string("java/util/List"), std::string("size"), std::string("()I"));
-		int size = priv.CallIntegerMethod(retval, listSize);
-		if (size > 0) {
-			WeatherCollection* wcollection = new WeatherCollection[size];
-			jmethodID listGet = priv.GetMethod(listClass, std::string("java/util/List"), std::string("get"), std::string("(I)Ljava/lang/Object;"));
-			JavaClassDef wcDef = { priv.GetClass("ca/wise/weather/WeatherCondition$WeatherCollection"), "ca/wise/weather/WeatherCondition$WeatherCollection" };
-			jfieldID hourFld = priv.GetField(wcDef, std::string("hour"), std::string("D"));
-			jfieldID epochFld = priv.GetField(wcDef, std::string("epoch"), std::string("J"));
-			jfieldID tempFld = priv.GetField(wcDef, std::string("temp"), std::string("D"));
-			jfieldID rhFld = priv.GetField(wcDef, std::string("rh"), std::string("D"));
-			jfieldID wdFld = priv.GetField(wcDef, std::string("wd"), std::string("D"));
-			jfieldID wsFld = priv.GetField(wcDef, std::string("ws"), std::string("D"));
-			jfieldID wgFld = priv.GetField(wcDef, std::string("wg"), std::string("D"));
-			jfieldID precipFld = priv.GetField(wcDef, std::string("precip"), std::string("D"));
-			jfieldID ffmcFld = priv.GetField(wcDef, std::string("ffmc"), std::string("D"));
-			jfieldID DMCFld = priv.GetField(wcDef, std::string("DMC"), std::string("D"));
-			jfieldID DCFld = priv.GetField(wcDef, std::string("DC"), std::string("D"));
-			jfieldID BUIFld = priv.GetField(wcDef, std::string("BUI"), std::string("D"));
-			jfieldID ISIFld = priv.GetField(wcDef, std::string("ISI"), std::string("D"));
-			jfieldID FWIFld = priv.GetField(wcDef, std::string("FWI"), std::string("D"));
-			jfieldID optionFld = priv.GetField(wcDef, std::string("options"), std::string("I"));
-
-			for (int i = 0; i < size; i++) {
-				jobject wc = priv.CallObjectMethod(retval, listGet, i);
-				WeatherCollection coll;
-				coll.hour = priv.CallDoubleField(wc, hourFld);
-				coll.epoch = (uint_fast64_t)priv.CallLongField(wc, epochFld);
-				coll.temp = priv.CallDoubleField(wc, tempFld);
-				coll.rh = priv.CallDoubleField(wc, rhFld);
-				coll.wd = priv.CallDoubleField(wc, wdFld);
-				coll.ws = priv.CallDoubleField(wc, wsFld);
-				coll.wg = priv.CallDoubleField(wc, wgFld);
-				coll.precip = priv.CallDoubleField(wc, precipFld);
-				coll.ffmc = priv.CallDoubleField(wc, ffmcFld);
-				coll.DMC = priv.CallDoubleField(wc, DMCFld);
-				coll.DC = priv.CallDoubleField(wc, DCFld);
-				coll.BUI = priv.CallDoubleField(wc, BUIFld);
-				coll.ISI = priv.CallDoubleField(wc, ISIFld);
-				coll.FWI = priv.CallDoubleField(wc, FWIFld);
-				coll.options = priv.CallIntField(wc, optionFld);
-				wcollection[i] = coll;
-			}
-			*length = size;
-			return wcollection;
-		}
-		else {
-			if (priv.ExceptionCheck()) {
-				*length = 0;
-				return nullptr;
-			}
-		}
-	}
-	else {
-		if (priv.ExceptionCheck()) {
-			*length = 0;
-			return nullptr;
-		}
-	}
-
-	*length = 0;
-	return nullptr;
+	priv.SetMemoryResource(resource);
 }
 
-ForecastCalculator::ForecastCalculator()
-	 : JavaObject(0, JavaClassDef()),
-	   m_location(nullptr, JavaClassDef()) {
+std::pmr::memory_resource* REDappWrapper::GetMemoryResource() {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	JavaClassDef def = { priv.GetClass("ca/weather/acheron/Calculator"), "ca/weather/acheron/Calculator" };
-	_type = def;
-	jmethodID mid = priv.GetMethod(_type, std::string("<init>"), std::string("()V"));
-	_internal = priv.NewObject((jclass)_type.data, mid, nullptr);
-	m_model = Model::GEM_DETER;
-	m_timezone = 0;
-	m_hack50 = -1;
+	return priv.MemoryResource();
 }
 
-
-ForecastCalculator::ForecastCalculator(const std::string& stream)
-	: JavaObject(0, JavaClassDef()),
-	m_location(nullptr, JavaClassDef()) {
+void REDappWrapper::SetWorkerCount(size_t count) {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	JavaClassDef def = { priv.GetClass("ca/weather/acheron/Calculator"), "ca/weather/acheron/Calculator" };
-	_type = def;
+	priv.SetWorkerCount(count);
 }
 
-
-#if !defined(__INTEL_COMPILER) && !defined(__INTEL_LLVM_COMPILER)
-static const int ForecastCalculatorVersion = 1;
-#else
-static constexpr int ForecastCalculatorVersion = 1;
-#endif
-
-std::string ForecastCalculator::toStreamable() {
-	std::stringstream stream;
-	stream << std::string("ACHERON;");
-	stream << ForecastCalculatorVersion;
-	stream << ";" << (short int)m_model << ";" << m_location.locationName() << ";" << m_timezone << ";" << m_date.toString() << ";" << (short int)m_time << ";";
-	for (int i : m_members) {
-		stream << i << ";";
-	}
-	return stream.str();
+size_t REDappWrapper::GetWorkerCount() {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	return priv.WorkerCount();
 }
 
-struct semicolon_is_space : std::ctype<char> {
-	semicolon_is_space() : std::ctype<char>(get_table()) { }
-	static mask const* get_table() {
-		static mask rc[table_size];
-		rc[';'] = std::ctype_base::space;
-		return &rc[0];
-	}
-};
+bool REDappWrapper::InternetDetected() {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	return priv.transactAny([&priv](NativeJVM& jvm) {
+		return jvm.CallStaticBooleanMethod(priv.Class(JavaRegistry::Class::WebDownloader),
+			priv.Method(JavaRegistry::Member::WebDownloader_hasInternetConnection), nullptr) ? true : false;
+	});
+}
 
-void ForecastCalculator::fromStreamable(std::string str) {
-	throw NotImplementedException();
-	std::stringstream stream(str);
-	stream.imbue(std::locale(stream.getloc(), new semicolon_is_space));
+void REDappWrapper::SetPathOverride(const std::string& path) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.SetPathOverride(path);
 }
 
-LocationWeatherGC ForecastCalculator::getWeather(bool* success) {
-	if (m_location.isValid()) {
+void REDappWrapper::Initialize() {
+	if (InternetDetected()) {
 		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-			jfieldID fid = priv.GetField(m_location._type, "locationName", "Ljava/lang/String;");
-		jmethodID setLocation = priv.GetMethod(_type, std::string("setLocation"), std::string("(Ljava/lang/String;)V"));
-		jstring name = (jstring)priv.CallObjectField((jobject)m_location._internal, fid);
-		priv.CallMethod((jobject)_internal, setLocation, name);
-		priv.FreeJString(name);
-		jmethodID setModel = priv.GetMethod(_type, std::string("setModel"), std::string("(Lca/weather/forecast/Model;)V"));
-		jobject mod = priv.NativeModelToJava(m_model);
-		priv.CallMethod((jobject)_internal, setModel, mod);
-		priv.DeleteObject(mod);
-		jmethodID setTime = priv.GetMethod(_type, std::string("setTime"), std::string("(Lca/weather/forecast/Time;)V"));
-		jobject tm = priv.NativeTimeToJava(m_time);
-		priv.CallMethod((jobject)_internal, setTime, tm);
-		priv.DeleteObject(tm);
-		if (m_model == REDapp::Model::CUSTOM) {
-			jmethodID clearMembers = priv.GetMethod(_type, std::string("clearMembers"), std::string("()V"));
-			priv.CallMethod((jobject)_internal, clearMembers, nullptr);
-			jmethodID addMember = priv.GetMethod(_type, std::string("addMember"), std::string("(I)V"));
-			for (std::vector<int>::iterator it = m_members.begin(); it != m_members.end(); ++it) {
-				priv.CallMethod((jobject)_internal, addMember, (jint)*it);
-			}
-		}
-		jclass WorldLocationClass = priv.GetClass("ca/hss/times/WorldLocation");
-		jmethodID getTimeZoneFromOffset = priv.GetStaticMethod(WorldLocationClass, "ca/hss/times/WorldLocation", std::string("getTimeZoneFromOffset"), std::string("(I)Lca/hss/times/TimeZoneInfo;"));
-		jint zero = 0;
-		jobject timezone = priv.CallStaticObjectMethod(WorldLocationClass, getTimeZoneFromOffset, zero);
-		jmethodID setTimezone = priv.GetMethod(_type, std::string("setTimezone"), std::string("(Lca/hss/times/TimeZoneInfo;)V"));
-		priv.CallMethod((jobject)_internal, setTimezone, timezone);
-		jmethodID setDate = priv.GetMethod(_type, std::string("setDate"), std::string("(Ljava/util/Calendar;)V"));
-		priv.CallMethod((jobject)_internal, setDate, (jobject)m_date._internal);
-		jboolean ret = 0;
-		if (m_hack50 > 0 && m_hack50 < 100) {
-			jmethodID setperc = priv.GetMethod(_type, std::string("setPercentile"), std::string("(I)V"));
-			priv.CallMethod((jobject)_internal, setperc, (jint)m_hack50);
-		}
-		jmethodID calculate = priv.GetMethod(_type, std::string("calculate"), std::string("()Z"));
-		ret = priv.CallBooleanMethod((jobject)_internal, calculate);
-		if (ret) {
-			*success = true;
-			jclass LocationWeatherClass = priv.GetClass("ca/weather/acheron/LocationWeather");
-			jint index = 0;
-			jmethodID getLocationsWeatherData = priv.GetMethod(_type, std::string("getLocationsWeatherData"), std::string("(I)Lca/weather/acheron/LocationWeather;"));
-			jobject weather = priv.CallObjectMethod((jobject)_internal, getLocationsWeatherData, index);
-			JavaClassDef def = { LocationWeatherClass, "ca/weather/acheron/LocationWeather" };
-			return LocationWeatherGC(weather, def);
-		}
+		priv.transact([&priv](NativeJVM& jvm) {
+			jobject list = jvm.CallStaticObjectMethod(priv.Class(JavaRegistry::Class::Calculator),
+				priv.Method(JavaRegistry::Member::Calculator_getLocations), nullptr);
+			jvm.DeleteLocalRef(list);
+		});
 	}
-	*success = false;
-	return LocationWeatherGC(0, JavaClassDef());
 }
 
-void LocationWeatherGC::getWeather(IWXData* data, size_t* size, size_t offset) {
+/**
+ * Fetch the cities in a province into a vector. Must be called from within a transaction.
+ */
+template<typename _Container>
+static void CitiesInto(NativeJVM& jvm, Province prov, _Container& list) {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jclass Iterator = priv.GetClass("java/util/Iterator");
-	jclass List = priv.GetClass("java/util/List");
-	jmethodID getHourData = priv.GetMethod(_type, std::string("getHourData"), std::string("()Ljava/util/List;"));
-	jobject list = priv.CallObjectMethodO((jobject)_internal, getHourData, nullptr);
-	jmethodID getiterator = priv.GetMethod(List, "java/util/List", std::string("iterator"), std::string("()Ljava/util/Iterator;"));
-	jobject iter = priv.CallObjectMethodO(list, getiterator, nullptr);
-	jclass Hour = priv.GetClass("ca/weather/acheron/Hour");
-	jmethodID iteratornext = priv.GetMethod(Iterator, "java/util/Iterator", std::string("next"), std::string("()Ljava/lang/Object;"));
-	jobject hour = priv.CallObjectMethodO(iter, iteratornext, nullptr);
-	jmethodID iteratorhasnext = priv.GetMethod(Iterator, "java/util/Iterator", std::string("hasNext"), std::string("()Z"));
-	jmethodID getTemperature = priv.GetMethod(Hour, "ca/weather/acheron/Hour", std::string("getTemperature"), std::string("()D"));
-	jmethodID getRelativeHumidity = priv.GetMethod(Hour, "ca/weather/acheron/Hour", std::string("getRelativeHumidity"), std::string("()D"));
-	jmethodID getPrecipitation = priv.GetMethod(Hour, "ca/weather/acheron/Hour", std::string("getPrecipitation"), std::string("()D"));
-	jmethodID getWindSpeed = priv.GetMethod(Hour, "ca/weather/acheron/Hour", std::string("getWindSpeed"), std::string("()D"));
-	jmethodID getWindDirection = priv.GetMethod(Hour, "ca/weather/acheron/Hour", std::string("getWindDirection"), std::string("()D"));
-	jmethodID getInterpolated = priv.GetMethod(Hour, "ca/weather/acheron/Hour", std::string("isInterpolated"), std::string("()Z"));
-	int j = 0;
-	while (true) {
-		if (j >= offset || !priv.CallBooleanMethod(iter, iteratorhasnext))
-			break;
-		hour = priv.CallObjectMethodO(iter, iteratornext, nullptr);
-		j++;
-	}
-	size_t count = 0;
-	if (priv.CallBooleanMethod(iter, iteratorhasnext)) {
-		for (int i = 0; i < *size; i++) {
-			data[i].Temperature = priv.CallDoubleMethod(hour, getTemperature);
-			data[i].RH = priv.CallDoubleMethod(hour, getRelativeHumidity) / 100.0;
-			data[i].Precipitation = priv.CallDoubleMethod(hour, getPrecipitation);
-			data[i].WindSpeed = priv.CallDoubleMethod(hour, getWindSpeed);
-			data[i].WindDirection = priv.CallDoubleMethod(hour, getWindDirection);
-			jboolean b = priv.CallBooleanMethod(hour, getInterpolated);
-			if (b) {
-				data[i].SpecifiedBits = 0x00000040;
-			}
-			else {
-				data[i].SpecifiedBits = 0;
-			}
-			count++;
-			if (!priv.CallBooleanMethod(iter, iteratorhasnext))
-				break;
-			hour = priv.CallObjectMethodO(iter, iteratornext, nullptr);
-		}
+	jobject jprov = ProvinceToJava(prov);
+	jclass citiesHelper = priv.Class(JavaRegistry::Class::CitiesHelper);
+	jmethodID getCities = priv.Method(JavaRegistry::Member::CitiesHelper_getCities);
+	jobjectArray citylist = (jobjectArray)jvm.CallStaticObjectMethod(citiesHelper, getCities, jprov);
+	jmethodID getName = priv.Method(JavaRegistry::Member::Cities_getName);
+	int length = jvm.GetArrayLength(citylist);
+	list.reserve(length);
+	for (int i = 0; i < length; i++) {
+		jobject j = jvm.GetObjectArrayElement(citylist, i);
+		jstring t = (jstring)jvm.CallObjectMethodO(j, getName, nullptr);
+		Cities city(JStringContent(jvm, t), (void*)REDappWrapperPrivate::Pin(jvm, j));
+		city.requiresDelete(true);
+		list.push_back(city);
+		jvm.DeleteLocalRef(t);
 	}
-	if (count != *size)
-		*size = count;
+	jvm.DeleteLocalRef(citylist);
 }
 
-Calendar LocationWeatherGC::startDate() {
+std::vector<Cities> REDappWrapper::getCities(Province prov) {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jclass CalendarCls = priv.GetClass("java/util/Calendar");
-	jmethodID getHourData50 = priv.GetMethod(_type, std::string("getHourData"), std::string("()Ljava/util/List;"));
-	jclass List = priv.GetClass("java/util/List");
-	jmethodID ListGet = priv.GetMethod(List, "java/util/List", std::string("get"), std::string("(I)Ljava/lang/Object;"));
-	jclass Hour = priv.GetClass("ca/weather/acheron/Hour");
-	jmethodID HourGetCalendarDate = priv.GetMethod(Hour, "ca/weather/acheron/Hour", std::string("getCalendarDate"), std::string("()Ljava/util/Calendar;"));
-	jobject lst = priv.CallObjectMethodO((jobject)_internal, getHourData50, nullptr);
-	jobject hr = priv.CallObjectMethod(lst, ListGet, 0);
-	jobject cl = priv.CallObjectMethodO(hr, HourGetCalendarDate, nullptr);
-	JavaClassDef def = { CalendarCls, "java/util/Calendar" };
-	return Calendar(cl, def);
+	return priv.transactAny([prov](NativeJVM& jvm) {
+		std::vector<Cities> list;
+		CitiesInto(jvm, prov, list);
+		return list;
+	});
 }
 
-size_t LocationWeatherGC::size() {
+std::pmr::vector<Cities> REDappWrapper::getCities(Province prov, std::pmr::memory_resource* resource) {
 	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
-	jmethodID mid = priv.GetMethod(_type, std::string("getHourData"), std::string("()Ljava/util/List;"));
-	jclass list = priv.GetClass(std::string("java/util/List"));
-	jmethodID msize = priv.GetMethod(list, "java/util/List", std::string("size"), std::string("()I"));
-	jobject data = priv.CallObjectMethodO((jobject)_internal, mid, nullptr);
-	jint sz = priv.CallIntegerMethod(data, msize);
-	return sz;
+	return priv.transactAny([prov, resource](NativeJVM& jvm) {
+		std::pmr::vector<Cities> list(ResultResource(resource));
+		CitiesInto(jvm, prov, list);
+		return list;
+	});
 }
 
-STANDARD_STRING_FIELD(LocationSmall, locationName)
+std::future<std::vector<Cities>> REDappWrapper::getCitiesAsync(Province prov) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	return priv.async([wrapper = *this, prov]() mutable { return wrapper.getCities(prov); });
+}
 
-STANDARD_STRING_GETTER(GCWeather, Observed)
-STANDARD_DOUBLE_GETTER(GCWeather, Temperature)
-STANDARD_DOUBLE_GETTER(GCWeather, Pressure)
-STANDARD_DOUBLE_GETTER(GCWeather, Visibility)
-STANDARD_DOUBLE_GETTER(GCWeather, Humidity)
-STANDARD_DOUBLE_GETTER(GCWeather, Windchill)
-STANDARD_DOUBLE_GETTER(GCWeather, Dewpoint)
-STANDARD_STRING_GETTER(GCWeather, WindDirection)
-STANDARD_DOUBLE_GETTER(GCWeather, WindSpeed)
+void REDappWrapper::getCitiesAsync(Province prov, Completion<std::vector<Cities>> callback) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.async([wrapper = *this, prov]() mutable { return wrapper.getCities(prov); }, std::move(callback));
 }
 
-/// Initialize Java.
-/// Adds the Java bin path to the DLL search path then creates a new JVM instance. This triggers the lazy loading of jvm.dll.
-void REDappWrapperPrivate::_init() {
-	if (m_thread)
-		delete m_thread;
+Awaitable<std::vector<Cities>> REDappWrapper::getCitiesAwait(Province prov, Executor executor) {
+	return Awaitable<std::vector<Cities>>([wrapper = *this, prov](Completion<std::vector<Cities>> done) mutable {
+		wrapper.getCitiesAsync(prov, std::move(done));
+	}, std::move(executor));
+}
 
-	m_thread = new WorkerThread();
-	m_classCache.clear();
-	m_methodCache.clear();
-	m_fieldCache.clear();
+Interpolator::Interpolator()
+	: JavaObject(0, JavaClassDef()) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	_type.name = "ca/weather/acheron/Interpolator";
+	priv.transact([this, &priv](NativeJVM& jvm) {
+		_type.data = priv.Class(JavaRegistry::Class::Interpolator);
+		jmethodID mid = priv.Method(JavaRegistry::Member::Interpolator_init);
+		_internal = REDappWrapperPrivate::Pin(jvm, jvm.NewObject((jclass)_type.data, mid, (jobject)nullptr));
+	});
+	requiresDelete(true);
+}
 
-	if (!m_jvm)
-		m_jvm = NativeJVM::construct();
-	WorkerThread::job_t job = [this] {
-		m_jvm->Initialize(m_overridePath);
-	};
-	run(job);
+/**
+ * Whether spline offsets and values can go to Java as primitive arrays through the adapter jar.
+ */
+static bool SplineArraysAvailable() {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	return priv.BulkTransfers() && priv.Method(JavaRegistry::Member::BulkTransfer_splineInterpolate);
 }
 
-REDappWrapperPrivate::~REDappWrapperPrivate() {
-	m_jvm = nullptr;
-	if (m_thread)
-	{
-		delete m_thread;
-		m_thread = nullptr;
-	}
+/**
+ * Interpolate offsets and values that are already in Java arrays with the adapter and copy the
+ * result into a vector. Returns false if the adapter couldn't run the interpolator, in which case
+ * ret hasn't been modified. Must be called from within a transaction.
+ */
+template<typename _Container>
+static bool SplineArraysInto(NativeJVM& jvm, jobject interpolator, jdoubleArray offsetarr, jdoubleArray valuearr, _Container& ret) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	jobjectArray retarr = (jobjectArray)jvm.CallStaticObjectMethodOOO(priv.Class(JavaRegistry::Class::BulkTransfer),
+		priv.Method(JavaRegistry::Member::BulkTransfer_splineInterpolate), interpolator, offsetarr, valuearr);
+	if (jvm.ExceptionCheck()) {
+		jvm.ExceptionClear();
+		retarr = nullptr;
+	}
+	if (!retarr)
+		return false;
+
+	bool done = false;
+	jdoubleArray retoffsets = (jdoubleArray)jvm.GetObjectArrayElement(retarr, 0);
+	jdoubleArray retvalues = (jdoubleArray)jvm.GetObjectArrayElement(retarr, 1);
+	int len = retoffsets ? jvm.GetArrayLength(retoffsets) : -1;
+	if (retvalues && len >= 0 && jvm.GetArrayLength(retvalues) == len) {
+		std::vector<jdouble> offsets(len), interpolated(len);
+		jvm.GetDoubleArrayRegion(retoffsets, 0, len, offsets.data());
+		jvm.GetDoubleArrayRegion(retvalues, 0, len, interpolated.data());
+		ret.reserve(len);
+		for (int i = 0; i < len; i++)
+			ret.emplace_back((int)offsets[i], interpolated[i]);
+		done = true;
+	}
+	if (retvalues)
+		jvm.DeleteLocalRef(retvalues);
+	if (retoffsets)
+		jvm.DeleteLocalRef(retoffsets);
+	jvm.DeleteLocalRef(retarr);
+	return done;
 }
 
-jobject REDappWrapperPrivate::NativeModelToJava(REDapp::Model mod) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,mod,this]{
-			jclass model = m_jvm->FindClass("ca/weather/forecast/Model");
-			jfieldID fid;
-			switch (mod)
-			{
-			case REDapp::Model::NCEP:
-				fid = m_jvm->GetStaticFieldID(model, "NCEP", "Lca/weather/forecast/Model;");
-				break;
-			case REDapp::Model::GEM:
-				fid = m_jvm->GetStaticFieldID(model, "GEM", "Lca/weather/forecast/Model;");
-				break;
-			case REDapp::Model::GEM_DETER:
-				fid = m_jvm->GetStaticFieldID(model, "GEM_DETER", "Lca/weather/forecast/Model;");
-				break;
-			case REDapp::Model::BOTH:
-				fid = m_jvm->GetStaticFieldID(model, "BOTH", "Lca/weather/forecast/Model;");
-				break;
-			default:
-				fid = m_jvm->GetStaticFieldID(model, "CUSTOM", "Lca/weather/forecast/Model;");
-				break;
-			}
-			retval = m_jvm->GetStaticObjectField(model, fid);
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+/**
+ * Run the Java spline interpolation into a vector by passing the offsets and values as primitive
+ * arrays, one bulk copy each way instead of a HourValue object per point. Returns false if the
+ * adapter isn't available or failed, in which case ret hasn't been modified. Must be called from
+ * within a transaction.
+ */
+template<typename _Container>
+static bool SplineInterpolateArrays(NativeJVM& jvm, jobject interpolator, const double* houroffsets, const double* values, int size, _Container& ret) {
+	if (!SplineArraysAvailable())
+		return false;
+	bool done = false;
+	jdoubleArray offsetarr = jvm.NewDoubleArray(size);
+	jdoubleArray valuearr = offsetarr ? jvm.NewDoubleArray(size) : nullptr;
+	if (valuearr) {
+		jvm.SetDoubleArrayRegion(offsetarr, 0, size, houroffsets);
+		jvm.SetDoubleArrayRegion(valuearr, 0, size, values);
+		done = SplineArraysInto(jvm, interpolator, offsetarr, valuearr, ret);
+	}
+	else if (jvm.ExceptionCheck())
+		jvm.ExceptionClear();
+	if (valuearr)
+		jvm.DeleteLocalRef(valuearr);
+	if (offsetarr)
+		jvm.DeleteLocalRef(offsetarr);
+	return done;
 }
 
-jobject REDappWrapperPrivate::NativeTimeToJava(REDapp::Time tim) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,tim,this]{
-			jclass model = m_jvm->FindClass("ca/weather/forecast/Time");
-			jfieldID fid;
-			switch (tim)
-			{
-			case REDapp::Time::MIDNIGHT:
-				fid = m_jvm->GetStaticFieldID(model, "MIDNIGHT", "Lca/weather/forecast/Time;");
-				break;
-			default:
-				fid = m_jvm->GetStaticFieldID(model, "NOON", "Lca/weather/forecast/Time;");
-				break;
-			}
-			retval = m_jvm->GetStaticObjectField(model, fid);
-		};
-		run(job);
-		return retval;
+/**
+ * Run the Java spline interpolation into a vector with a HourValue object per point. Must be
+ * called from within a transaction.
+ */
+template<typename _Container>
+static void SplineHourValuesInto(NativeJVM& jvm, jobject interpolator, const double* houroffsets, const double* values, int size, _Container& ret) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	jclass hourvaluescls = priv.Class(JavaRegistry::Class::HourValue);
+	jmethodID hourvaluesconst = priv.Method(JavaRegistry::Member::HourValue_init);
+	jfieldID houroffsetfld = priv.Field(JavaRegistry::Member::HourValue_houroffset);
+	jfieldID valuefld = priv.Field(JavaRegistry::Member::HourValue_value);
+	jobjectArray oarr = jvm.NewObjectArray(size, hourvaluescls);
+	for (int i = 0; i < size; i++) {
+		jobject obj = jvm.NewObject(hourvaluescls, hourvaluesconst, nullptr);
+		jvm.SetDoubleField(obj, houroffsetfld, houroffsets[i]);
+		jvm.SetDoubleField(obj, valuefld, values[i]);
+		jvm.SetObjectArrayElement(oarr, i, obj);
+		jvm.DeleteLocalRef(obj);
 	}
-	return nullptr;
-}
 
-jobject REDappWrapperPrivate::NativeProvinceToJava(REDapp::Province prov) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,prov,this]{
-			jclass province = m_jvm->FindClass("ca/weather/forecast/Province");
-			jfieldID fid;
-			switch (prov)
-			{
-			case REDapp::Province::ALBERTA:
-				fid = m_jvm->GetStaticFieldID(province, "ALBERTA", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::BRITISH_COLUMBIA:
-				fid = m_jvm->GetStaticFieldID(province, "BRITISH_COLUMBIA", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::NEW_BRUNSWICK:
-				fid = m_jvm->GetStaticFieldID(province, "NEW_BRUNSWICK", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::NEWFOUNDLAND_AND_LABRADOR:
-				fid = m_jvm->GetStaticFieldID(province, "NEWFOUNDLAND_AND_LABRADOR", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::NORTHWEST_TERRITORIES:
-				fid = m_jvm->GetStaticFieldID(province, "NORTHWEST_TERRITORIES", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::NOVA_SCOTIA:
-				fid = m_jvm->GetStaticFieldID(province, "NOVA_SCOTIA", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::NUNAVUT:
-				fid = m_jvm->GetStaticFieldID(province, "NUNAVUT", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::ONTARIO:
-				fid = m_jvm->GetStaticFieldID(province, "ONTARIO", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::PRINCE_EDWARD_ISLAND:
-				fid = m_jvm->GetStaticFieldID(province, "PRINCE_EDWARD_ISLAND", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::QUEBEC:
-				fid = m_jvm->GetStaticFieldID(province, "QUEBEC", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::SASKATCHEWAN:
-				fid = m_jvm->GetStaticFieldID(province, "SASKATCHEWAN", "Lca/weather/forecast/Province;");
-				break;
-			case REDapp::Province::YUKON:
-				fid = m_jvm->GetStaticFieldID(province, "YUKON", "Lca/weather/forecast/Province;");
-				break;
-			default:
-				fid = m_jvm->GetStaticFieldID(province, "MANITOBA", "Lca/weather/forecast/Province;");
-				break;
-			}
-			retval = m_jvm->GetStaticObjectField(province, fid);
-		};
-		run(job);
-		return retval;
+	jmethodID splineint = priv.Method(JavaRegistry::Member::Interpolator_splineInterpolate);
+	jobjectArray retarr = (jobjectArray)jvm.CallObjectMethodO(interpolator, splineint, oarr);
+
+	int len = jvm.GetArrayLength(retarr);
+	ret.reserve(len);
+	for (int i = 0; i < len; i++) {
+		jobject v = jvm.GetObjectArrayElement(retarr, i);
+		std::pair<int, double> val;
+		val.first = jvm.GetDoubleField(v, houroffsetfld);
+		val.second = jvm.GetDoubleField(v, valuefld);
+		ret.push_back(val);
+		jvm.DeleteLocalRef(v);
 	}
-	return nullptr;
+	jvm.DeleteLocalRef(oarr);
+	jvm.DeleteLocalRef(retarr);
 }
 
-jclass REDappWrapperPrivate::GetClass(const std::string& name) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jclass retval = nullptr;
-		WorkerThread::job_t job = [&retval,name,this]{
-			retval = m_classCache.create(name, m_jvm.get());
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+/**
+ * Run the Java spline interpolation into a vector, as primitive arrays if the adapter jar is
+ * loaded and bulk transfers are turned on. Must be called from within a transaction.
+ */
+template<typename _Container>
+static void SplineInterpolateInto(NativeJVM& jvm, jobject interpolator, const double* houroffsets, const double* values, int size, _Container& ret) {
+	if (!SplineInterpolateArrays(jvm, interpolator, houroffsets, values, size, ret))
+		SplineHourValuesInto(jvm, interpolator, houroffsets, values, size, ret);
 }
 
-jmethodID REDappWrapperPrivate::GetStaticMethod(REDapp::JavaClassDef& cls, const std::string& name, const std::string& sig) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jmethodID retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,name,sig,this]{
-			retval = m_methodCache.createStatic((jclass)cls.data, cls.name, name, sig, m_jvm.get());
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+/**
+ * Run the native spline interpolation into a vector. Returns false if the native spline doesn't
+ * accept the input.
+ */
+template<typename _Container>
+static bool NativeSplineInto(const double* houroffsets, const double* values, int size, _Container& ret) {
+	NaturalCubicSpline spline;
+	if (!spline.setKnots(houroffsets, size))
+		return false;
+	spline.fit(values);
+	int first = spline.firstHour();
+	int count = spline.hourCount();
+	std::vector<double> hours(count);
+	spline.evaluateHours(hours.data());
+	ret.reserve(count);
+	for (int i = 0; i < count; i++)
+		ret.emplace_back(first + i, hours[i]);
+	return true;
 }
 
-jmethodID REDappWrapperPrivate::GetStaticMethod(jclass cls, const std::string& clsname, const std::string& name, const std::string& sig) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jmethodID retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,clsname,name,sig,this]{
-			retval = m_methodCache.createStatic(cls, clsname, name, sig, m_jvm.get());
-		};
-		run(job);
-		return retval;
+/**
+ * Check whether a native interpolation matches a Java one within Interpolator::SplineTolerance.
+ */
+template<typename _Container>
+static bool SameSpline(const _Container& native, const _Container& java) {
+	if (native.size() != java.size())
+		return false;
+	for (size_t i = 0; i < native.size(); i++) {
+		if (native[i].first != java[i].first)
+			return false;
+		double scale = std::max(1.0, std::abs(java[i].second));
+		if (!(std::abs(native[i].second - java[i].second) <= Interpolator::SplineTolerance * scale))
+			return false;
 	}
-	return nullptr;
+	return true;
 }
 
-jobject REDappWrapperPrivate::CallStaticObjectMethod(jclass cls, jmethodID mid, jobject param) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,mid,param,this]{
-			retval = m_jvm->CallStaticObjectMethod(cls, mid, param);
-		};
-		run(job);
-		return retval;
+/**
+ * Interpolate with whichever engine is selected.
+ */
+template<typename _Container>
+static void SplineInterpolateWith(Interpolator::SplineEngine engine, jobject interpolator, const double* houroffsets, const double* values, int size, _Container& ret) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	REDappWrapperPrivate::spline_counters& counters = priv.SplineCounters();
+	if (engine == Interpolator::SplineEngine::NATIVE) {
+		if (NativeSplineInto(houroffsets, values, size, ret)) {
+			counters.nativeFits.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		counters.javaFallbacks.fetch_add(1, std::memory_order_relaxed);
 	}
-	return nullptr;
-}
 
-jobject REDappWrapperPrivate::CallStaticObjectMethod(jclass cls, jmethodID mid, jint param) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,mid,param,this]{
-			retval = m_jvm->CallStaticObjectMethod(cls, mid, param);
-		};
-		run(job);
-		return retval;
+	priv.transactAny([&](NativeJVM& jvm) {
+		SplineInterpolateInto(jvm, interpolator, houroffsets, values, size, ret);
+	});
+
+	if (engine == Interpolator::SplineEngine::VERIFY) {
+		_Container native(ret.get_allocator());
+		if (NativeSplineInto(houroffsets, values, size, native)) {
+			counters.verified.fetch_add(1, std::memory_order_relaxed);
+			if (!SameSpline(native, ret))
+				counters.mismatches.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+			counters.javaFallbacks.fetch_add(1, std::memory_order_relaxed);
 	}
-	return nullptr;
 }
 
-jboolean REDappWrapperPrivate::CallStaticBooleanMethod(jclass cls, jmethodID mid, jobject param) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jboolean retval = false;
-		WorkerThread::job_t job = [&retval,cls,mid,param,this]{
-			retval = m_jvm->CallStaticBooleanMethod(cls, mid, param);
-		};
-		run(job);
-		return retval;
-	}
-	return (unsigned char)-1;
+std::vector<std::pair<int, double>> Interpolator::SplineInterpolate(double* houroffsets, double* values, int size) {
+	std::vector<std::pair<int, double>> ret;
+	SplineInterpolateWith(m_engine, (jobject)_internal, houroffsets, values, size, ret);
+	return ret;
 }
 
-jobject REDappWrapperPrivate::CallObjectMethodO(jobject obj, jmethodID mid, jobject o) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,obj,mid,o,this]{
-			retval = m_jvm->CallObjectMethodO(obj, mid, o);
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+std::pmr::vector<std::pair<int, double>> Interpolator::SplineInterpolate(double* houroffsets, double* values, int size, std::pmr::memory_resource* resource) {
+	std::pmr::vector<std::pair<int, double>> ret(ResultResource(resource));
+	SplineInterpolateWith(m_engine, (jobject)_internal, houroffsets, values, size, ret);
+	return ret;
 }
 
-jobject REDappWrapperPrivate::CallObjectMethodOO(jobject obj, jmethodID mid, jobject o1, jobject o2) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,obj,mid,o1,o2,this]{
-			retval = m_jvm->CallObjectMethodOO(obj, mid, o1, o2);
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+Awaitable<std::vector<std::pair<int, double>>> Interpolator::SplineInterpolateAwait(double* houroffsets, double* values, int size, Executor executor) {
+	typedef std::vector<std::pair<int, double>> result_t;
+	return Awaitable<result_t>([this, houroffsets, values, size](Completion<result_t> done) {
+		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+		priv.async([this, houroffsets, values, size]() { return SplineInterpolate(houroffsets, values, size); }, std::move(done));
+	}, std::move(executor));
 }
 
-jobject REDappWrapperPrivate::CallObjectMethodOOI(jobject obj, jmethodID mid, jobject o1, jobject o2, jint i1) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval, obj, mid, o1, o2, i1, this] {
-			retval = m_jvm->CallObjectMethodOOI(obj, mid, o1, o2, i1);
-		};
-		run(job);
-		return retval;
+/**
+ * Group the series passed to SplineInterpolateMany by their hour offsets. Each group holds the
+ * indices of series whose offsets are identical, in the order they were passed.
+ */
+static std::vector<std::vector<size_t>> GroupByKnots(const std::vector<Interpolator::SplineSeries>& series) {
+	std::vector<std::vector<size_t>> groups;
+	std::unordered_multimap<size_t, size_t> byHash;
+	for (size_t i = 0; i < series.size(); i++) {
+		const Interpolator::SplineSeries& current = series[i];
+		std::string_view bytes(reinterpret_cast<const char*>(current.houroffsets), current.houroffsets ? current.size * sizeof(double) : 0);
+		size_t hash = std::hash<std::string_view>()(bytes);
+		auto range = byHash.equal_range(hash);
+		auto found = std::find_if(range.first, range.second, [&](const std::pair<const size_t, size_t>& g) {
+			const Interpolator::SplineSeries& first = series[groups[g.second].front()];
+			return first.size == current.size &&
+				(first.houroffsets == current.houroffsets || std::equal(first.houroffsets, first.houroffsets + first.size, current.houroffsets));
+		});
+		if (found != range.second)
+			groups[found->second].push_back(i);
+		else {
+			byHash.emplace(hash, groups.size());
+			groups.push_back({ i });
+		}
 	}
-	return nullptr;
+	return groups;
 }
 
-jobject REDappWrapperPrivate::CallObjectMethod(jobject obj, jmethodID mid, jint ind) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,obj,mid,ind,this]{
-			retval = m_jvm->CallObjectMethod(obj, mid, ind);
-		};
-		run(job);
-		return retval;
+/**
+ * Interpolate every series in a group natively, factoring the spline once for the shared offsets.
+ * Falls back to interpolating each series on its own if the native spline doesn't accept the offsets.
+ */
+static void NativeSplineGroup(jobject interpolator, const std::vector<Interpolator::SplineSeries>& series, const std::vector<size_t>& group,
+		std::vector<std::vector<std::pair<int, double>>>& ret) {
+	const Interpolator::SplineSeries& knots = series[group.front()];
+	NaturalCubicSpline spline;
+	if (!knots.houroffsets || !spline.setKnots(knots.houroffsets, knots.size)) {
+		for (size_t index : group)
+			SplineInterpolateWith(Interpolator::SplineEngine::NATIVE, interpolator, series[index].houroffsets, series[index].values, series[index].size, ret[index]);
+		return;
 	}
-	return nullptr;
-}
 
-jdouble REDappWrapperPrivate::CallDoubleMethod(jobject obj, jmethodID mid, ...) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jdouble retval;
-		va_list vl;
-		va_start(vl, mid);
-		WorkerThread::job_t job = [&retval,obj,mid,vl,this]{
-			retval = m_jvm->CallDoubleMethod(obj, mid, vl);
-		};
-		run(job);
-		va_end(vl);
-		return retval;
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	int first = spline.firstHour();
+	int count = spline.hourCount();
+	std::vector<double> hours(count);
+	for (size_t index : group) {
+		spline.fit(series[index].values);
+		spline.evaluateHours(hours.data());
+		std::vector<std::pair<int, double>>& out = ret[index];
+		out.reserve(count);
+		for (int i = 0; i < count; i++)
+			out.emplace_back(first + i, hours[i]);
 	}
-	return 0.0;
+	priv.SplineCounters().nativeFits.fetch_add(group.size(), std::memory_order_relaxed);
 }
 
-jdouble REDappWrapperPrivate::CallObjectDoubleMethod(jobject obj, jmethodID mid, ...) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jdouble dval;
-		va_list vl;
-		va_start(vl, mid);
-		WorkerThread::job_t job = [&dval,obj,mid,vl,this]{
-			jobject retval = m_jvm->CallObjectDoubleMethod(obj, mid, vl);
-			if (retval == nullptr)
-				dval = std::numeric_limits<double>::infinity();
-			jclass cls = m_jvm->FindClass("java/lang/Double");
-			jmethodID mid = m_jvm->GetMethodID(cls, "doubleValue", "()D");
-			dval = m_jvm->CallDoubleMethod(retval, mid);
-		};
-		run(job);
-		va_end(vl);
-		return dval;
+/**
+ * Interpolate every series in a group through the adapter jar, copying the shared offsets into
+ * Java once. Series the adapter fails on fall back to HourValue objects. Returns false if the
+ * adapter isn't available or the arrays couldn't be created. Must be called from within a transaction.
+ */
+static bool JavaSplineGroupArrays(NativeJVM& jvm, jobject interpolator, const std::vector<Interpolator::SplineSeries>& series,
+		const std::vector<size_t>& group, std::vector<std::vector<std::pair<int, double>>>& ret) {
+	if (!SplineArraysAvailable())
+		return false;
+	const Interpolator::SplineSeries& knots = series[group.front()];
+	int size = knots.size;
+	jdoubleArray offsetarr = jvm.NewDoubleArray(size);
+	jdoubleArray valuearr = offsetarr ? jvm.NewDoubleArray(size) : nullptr;
+	bool created = valuearr != nullptr;
+	if (created) {
+		jvm.SetDoubleArrayRegion(offsetarr, 0, size, knots.houroffsets);
+		for (size_t index : group) {
+			jvm.SetDoubleArrayRegion(valuearr, 0, size, series[index].values);
+			if (!SplineArraysInto(jvm, interpolator, offsetarr, valuearr, ret[index]))
+				SplineHourValuesInto(jvm, interpolator, knots.houroffsets, series[index].values, size, ret[index]);
+		}
 	}
-	return 0.0;
+	else if (jvm.ExceptionCheck())
+		jvm.ExceptionClear();
+	if (valuearr)
+		jvm.DeleteLocalRef(valuearr);
+	if (offsetarr)
+		jvm.DeleteLocalRef(offsetarr);
+	return created;
 }
 
-jboolean REDappWrapperPrivate::CallBooleanMethod(jobject obj, jmethodID mid) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jboolean retval;
-		WorkerThread::job_t job = [&retval,obj,mid,this]{
-			retval = m_jvm->CallBooleanMethod(obj, mid);
-		};
-		run(job);
-		return retval;
+/**
+ * Interpolate every series in a group through Java inside a single transaction. Without the adapter
+ * jar the HourValue array is built once with the shared offsets and only its values are rewritten
+ * for each series.
+ * With SplineEngine::VERIFY the native spline is factored once for the group and compared against
+ * each Java result.
+ */
+static void JavaSplineGroup(Interpolator::SplineEngine engine, jobject interpolator, const std::vector<Interpolator::SplineSeries>& series,
+		const std::vector<size_t>& group, std::vector<std::vector<std::pair<int, double>>>& ret) {
+	const Interpolator::SplineSeries& knots = series[group.front()];
+	if (!knots.houroffsets) {
+		for (size_t index : group)
+			SplineInterpolateWith(engine, interpolator, series[index].houroffsets, series[index].values, series[index].size, ret[index]);
+		return;
 	}
-	return false;
-}
 
-jboolean REDappWrapperPrivate::CallBooleanMethod(jobject obj, jmethodID mid, int param) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jboolean retval;
-		WorkerThread::job_t job = [&retval,obj,mid,param,this]{
-			retval = m_jvm->CallBooleanMethod(obj, mid, param);
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.transactAny([&](NativeJVM& jvm) {
+		if (JavaSplineGroupArrays(jvm, interpolator, series, group, ret))
+			return;
+		jclass hourvaluescls = priv.Class(JavaRegistry::Class::HourValue);
+		jmethodID hourvaluesconst = priv.Method(JavaRegistry::Member::HourValue_init);
+		jfieldID houroffsetfld = priv.Field(JavaRegistry::Member::HourValue_houroffset);
+		jfieldID valuefld = priv.Field(JavaRegistry::Member::HourValue_value);
+		jmethodID splineint = priv.Method(JavaRegistry::Member::Interpolator_splineInterpolate);
+		int size = knots.size;
+		jobjectArray oarr = jvm.NewObjectArray(size, hourvaluescls);
+		std::vector<jobject> elements(size);
+		for (int i = 0; i < size; i++) {
+			elements[i] = jvm.NewObject(hourvaluescls, hourvaluesconst, nullptr);
+			jvm.SetDoubleField(elements[i], houroffsetfld, knots.houroffsets[i]);
+			jvm.SetObjectArrayElement(oarr, i, elements[i]);
+		}
+
+		for (size_t index : group) {
+			const double* values = series[index].values;
+			for (int i = 0; i < size; i++)
+				jvm.SetDoubleField(elements[i], valuefld, values[i]);
+			jobjectArray retarr = (jobjectArray)jvm.CallObjectMethodO(interpolator, splineint, oarr);
+			std::vector<std::pair<int, double>>& out = ret[index];
+			int len = jvm.GetArrayLength(retarr);
+			out.reserve(len);
+			for (int i = 0; i < len; i++) {
+				jobject v = jvm.GetObjectArrayElement(retarr, i);
+				out.emplace_back((int)jvm.GetDoubleField(v, houroffsetfld), jvm.GetDoubleField(v, valuefld));
+				jvm.DeleteLocalRef(v);
+			}
+			jvm.DeleteLocalRef(retarr);
+		}
+
+		for (jobject obj : elements)
+			jvm.DeleteLocalRef(obj);
+		jvm.DeleteLocalRef(oarr);
+	});
+
+	if (engine != Interpolator::SplineEngine::VERIFY)
+		return;
+	REDappWrapperPrivate::spline_counters& counters = priv.SplineCounters();
+	NaturalCubicSpline spline;
+	if (!spline.setKnots(knots.houroffsets, knots.size)) {
+		counters.javaFallbacks.fetch_add(group.size(), std::memory_order_relaxed);
+		return;
+	}
+	int first = spline.firstHour();
+	int count = spline.hourCount();
+	std::vector<double> hours(count);
+	std::vector<std::pair<int, double>> native;
+	native.reserve(count);
+	for (size_t index : group) {
+		spline.fit(series[index].values);
+		spline.evaluateHours(hours.data());
+		native.clear();
+		for (int i = 0; i < count; i++)
+			native.emplace_back(first + i, hours[i]);
+		if (!SameSpline(native, ret[index]))
+			counters.mismatches.fetch_add(1, std::memory_order_relaxed);
+	}
+	counters.verified.fetch_add(group.size(), std::memory_order_relaxed);
+}
+
+std::vector<std::vector<std::pair<int, double>>> Interpolator::SplineInterpolateMany(const std::vector<SplineSeries>& series) {
+	std::vector<std::vector<std::pair<int, double>>> ret(series.size());
+	std::vector<std::vector<size_t>> groups = GroupByKnots(series);
+	jobject interpolator = (jobject)_internal;
+	SplineEngine engine = m_engine;
+	if (groups.empty())
+		return ret;
+
+	if (engine == SplineEngine::NATIVE) {
+		//native fits don't need Java so the calling thread and a few helpers split the groups
+		//between them. A worker fits them all itself since a group the native spline rejects
+		//goes to Java and the helper would wait on that worker.
+		std::atomic<size_t> next{ 0 };
+		std::mutex errorLock;
+		std::exception_ptr error;
+		auto fitGroups = [&]() {
+			for (size_t i = next++; i < groups.size(); i = next++) {
+				try {
+					NativeSplineGroup(interpolator, series, groups[i], ret);
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> l(errorLock);
+					if (!error)
+						error = std::current_exception();
+				}
+			}
 		};
-		run(job);
-		return retval;
+		size_t helpers = 0;
+		if (!WorkerThread::current())
+			helpers = std::min<size_t>(groups.size(), std::max(std::thread::hardware_concurrency(), 1u)) - 1;
+		std::vector<std::thread> threads;
+		threads.reserve(helpers);
+		for (size_t i = 0; i < helpers; i++)
+			threads.emplace_back(fitGroups);
+		fitGroups();
+		for (std::thread& t : threads)
+			t.join();
+		if (error)
+			std::rethrow_exception(error);
+		return ret;
 	}
-	return false;
-}
 
-jint REDappWrapperPrivate::CallIntegerMethod(jobject obj, jmethodID mid) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jint retval;
-		WorkerThread::job_t job = [&retval,obj,mid,this]{
-			retval = m_jvm->CallIntMethod(obj, mid);
-		};
-		run(job);
-		return retval;
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	std::vector<std::future<void>> pending;
+	pending.reserve(groups.size());
+	for (const std::vector<size_t>& group : groups)
+		pending.push_back(priv.async([&, engine, interpolator]() { JavaSplineGroup(engine, interpolator, series, group, ret); }));
+
+	//wait for every job before rethrowing so none are left writing into ret
+	std::exception_ptr error;
+	for (std::future<void>& f : pending) {
+		try {
+			f.get();
+		}
+		catch (...) {
+			if (!error)
+				error = std::current_exception();
+		}
 	}
-	return 0;
+	if (error)
+		std::rethrow_exception(error);
+	return ret;
 }
 
-jint REDappWrapperPrivate::CallIntegerMethod(jobject obj, jmethodID mid, jint param) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jint retval;
-		WorkerThread::job_t job = [&retval,obj,mid,param,this]{
-			retval = m_jvm->CallIntMethod(obj, mid, param);
-		};
-		run(job);
-		return retval;
-	}
-	return 0;
+/**
+ * Fetch the forecast locations in a province into a vector. Must be called from within a transaction.
+ */
+template<typename _Container>
+static void ForecastCitiesInto(NativeJVM& jvm, Province prov, _Container& retval) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	jclass Calculator = priv.Class(JavaRegistry::Class::Calculator);
+	jobject province = ProvinceToJava(prov);
+	jmethodID getLocations = priv.Method(JavaRegistry::Member::Calculator_getProvinceLocations);
+	jobject list = jvm.CallStaticObjectMethod(Calculator, getLocations, province);
+	jmethodID size = priv.Method(JavaRegistry::Member::List_size);
+	jmethodID get = priv.Method(JavaRegistry::Member::List_get);
+	jclass LocationSmallClass = priv.Class(JavaRegistry::Class::LocationSmall);
+	int s = jvm.CallIntMethod(list, size);
+	retval.reserve(s);
+	JavaClassDef def = { LocationSmallClass, "ca/weather/acheron/Calculator$LocationSmall" };
+	jfieldID name = priv.Field(JavaRegistry::Member::LocationSmall_locationName);
+	for (int i = 0; i < s; i++) {
+		jobject ind = REDappWrapperPrivate::Pin(jvm, jvm.CallObjectMethod(list, get, i));
+		jstring str = (jstring)jvm.GetObjectField(ind, name);
+		LocationSmall loc(ind, def, JStringContent(jvm, str), prov);
+		loc.requiresDelete(true);
+		jvm.DeleteLocalRef(str);
+		retval.push_back(loc);
+	}
+	jvm.DeleteLocalRef(list);
 }
 
-jlong REDappWrapperPrivate::CallLongMethod(jobject obj, jmethodID mid) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jlong retval;
-		WorkerThread::job_t job = [&retval,obj,mid,this]{
-			retval = m_jvm->CallLongMethod(obj, mid);
-		};
-		run(job);
-		return retval;
+std::vector<LocationSmall> ForecastCalculator::getForecastCities(Province prov) {
+	if (REDappWrapper::InternetDetected()) {
+		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+		return priv.transactAny([prov](NativeJVM& jvm) {
+			std::vector<LocationSmall> retval;
+			ForecastCitiesInto(jvm, prov, retval);
+			return retval;
+		});
 	}
-	return 0;
+	return std::vector<LocationSmall>();
 }
 
-void REDappWrapperPrivate::CallMethod(jobject obj, jmethodID mid, jobject param) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		WorkerThread::job_t job = [obj,mid,param,this]{
-			m_jvm->CallMethod(obj, mid, param);
-		};
-		run(job);
+std::pmr::vector<LocationSmall> ForecastCalculator::getForecastCities(Province prov, std::pmr::memory_resource* resource) {
+	if (REDappWrapper::InternetDetected()) {
+		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+		return priv.transactAny([prov, resource](NativeJVM& jvm) {
+			std::pmr::vector<LocationSmall> retval(ResultResource(resource));
+			ForecastCitiesInto(jvm, prov, retval);
+			return retval;
+		});
 	}
+	return std::pmr::vector<LocationSmall>(ResultResource(resource));
 }
 
-void REDappWrapperPrivate::CallMethod(jobject obj, jmethodID mid, jint param) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		WorkerThread::job_t job = [obj,mid,param,this]{
-			m_jvm->CallMethod(obj, mid, param);
-		};
-		run(job);
-	}
+GCWeather REDappWrapper::getGCWeather(Cities city) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	JavaClassDef def = { nullptr, "ca/weather/current/CurrentWeather" };
+	jobject weather = priv.transactAny([&def, &city, &priv](NativeJVM& jvm) {
+		def.data = priv.Class(JavaRegistry::Class::CurrentWeather);
+		jmethodID CurrentWeatherInit = priv.Method(JavaRegistry::Member::CurrentWeather_init);
+		return REDappWrapperPrivate::Pin(jvm, jvm.NewObject((jclass)def.data, CurrentWeatherInit, (jobject)city._internal));
+	});
+	GCWeather retval((void*)weather, def);
+	retval.requiresDelete(true);
+	return retval;
 }
 
-void REDappWrapperPrivate::CallMethod(jobject obj, jmethodID mid, jint param1, jint param2) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		WorkerThread::job_t job = [obj,mid,param1,param2,this]{
-			m_jvm->CallMethod(obj, mid, param1, param2);
-		};
-		run(job);
-	}
+std::future<GCWeather> REDappWrapper::getGCWeatherAsync(Cities city) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	return priv.async([wrapper = *this, city]() mutable { return wrapper.getGCWeather(city); });
 }
 
-void REDappWrapperPrivate::CallMethod(jobject obj, jmethodID mid, jdouble param) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		WorkerThread::job_t job = [obj,mid,param,this]{
-			m_jvm->CallMethod(obj, mid, param);
-		};
-		run(job);
-	}
+void REDappWrapper::getGCWeatherAsync(Cities city, Completion<GCWeather> callback) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.async([wrapper = *this, city]() mutable { return wrapper.getGCWeather(city); }, std::move(callback));
 }
 
-void REDappWrapperPrivate::CallMethod(jobject obj, jmethodID mid, jlong param) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		WorkerThread::job_t job = [obj,mid,param,this]{
-			m_jvm->CallMethod(obj, mid, param);
-		};
-		run(job);
+std::future<std::vector<LocationSmall>> ForecastCalculator::getForecastCitiesAsync(Province prov) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	return priv.async([this, prov]() { return getForecastCities(prov); });
+}
+
+void ForecastCalculator::getForecastCitiesAsync(Province prov, Completion<std::vector<LocationSmall>> callback) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.async([this, prov]() { return getForecastCities(prov); }, std::move(callback));
+}
+
+Awaitable<std::vector<LocationSmall>> ForecastCalculator::getForecastCitiesAwait(Province prov, Executor executor) {
+	return Awaitable<std::vector<LocationSmall>>([this, prov](Completion<std::vector<LocationSmall>> done) {
+		getForecastCitiesAsync(prov, std::move(done));
+	}, std::move(executor));
+}
+
+enum class CalendarType {
+	ERA = 0,
+	YEAR = 1,
+	MONTH = 2,
+	WEEK_OF_YEAR = 3,
+	WEEK_OF_MONTH = 4,
+	DATE = 5,
+	DAY_OF_MONTH = 5,
+	DAY_OF_YEAR = 6,
+	DAY_OF_WEEK = 7,
+	DAY_OF_WEEK_IN_MONTH = 8,
+	AM_PM = 9,
+	HOUR = 10,
+	HOUR_OF_DAY = 11,
+	MINUTE = 12,
+	SECOND = 13,
+	MILLISECOND = 14,
+	ZONE_OFFSET = 15,
+	DST_OFFSET = 16
+};
+
+/**
+ * The fields of a calendar, indexed by CalendarType.
+ */
+struct CalendarFields {
+	int year;
+	int month;
+	int day;
+	int hour;
+	int minute;
+	int second;
+	int millisecond;
+
+	int* field(CalendarType type) {
+		switch (type) {
+		case CalendarType::YEAR: return &year;
+		case CalendarType::MONTH: return &month;
+		case CalendarType::DAY_OF_MONTH: return &day;
+		case CalendarType::HOUR_OF_DAY: return &hour;
+		case CalendarType::MINUTE: return &minute;
+		case CalendarType::SECOND: return &second;
+		case CalendarType::MILLISECOND: return &millisecond;
+		default: return nullptr;
+		}
+	}
+};
+
+/**
+ * Split a time into its calendar fields.
+ */
+static CalendarFields SplitCalendar(Calendar::time_type time) {
+	std::chrono::sys_days days = std::chrono::floor<std::chrono::days>(time);
+	std::chrono::year_month_day ymd(days);
+	std::chrono::hh_mm_ss<std::chrono::milliseconds> hms(time - days);
+	return CalendarFields{ (int)ymd.year(), (int)(unsigned)ymd.month() - 1, (int)(unsigned)ymd.day(),
+		(int)hms.hours().count(), (int)hms.minutes().count(), (int)hms.seconds().count(), (int)hms.subseconds().count() };
+}
+
+/**
+ * Join calendar fields back into a time. Fields out of range roll over the same way a lenient
+ * java.util.Calendar does.
+ */
+static Calendar::time_type JoinCalendar(const CalendarFields& fields) {
+	int year = fields.year + fields.month / 12;
+	int month = fields.month % 12;
+	if (month < 0) {
+		month += 12;
+		year--;
+	}
+	std::chrono::sys_days days = std::chrono::sys_days(std::chrono::year(year) / std::chrono::month(month + 1) / 1) + std::chrono::days(fields.day - 1);
+	return days + std::chrono::hours(fields.hour) + std::chrono::minutes(fields.minute) + std::chrono::seconds(fields.second) + std::chrono::milliseconds(fields.millisecond);
+}
+
+/**
+ * Format the time zone of a calendar the way SimpleDateFormat formats z for a fixed offset.
+ */
+static std::string FormatZone(std::chrono::milliseconds offset) {
+	if (offset.count() == 0)
+		return "UTC";
+	long minutes = (long)std::chrono::duration_cast<std::chrono::minutes>(offset).count();
+	char sign = minutes < 0 ? '-' : '+';
+	minutes = std::abs(minutes);
+	char buffer[48];
+	snprintf(buffer, sizeof(buffer), "GMT%c%02ld:%02ld", sign, minutes / 60, minutes % 60);
+	return buffer;
+}
+
+/**
+ * Parse a time zone written as UTC, GMT or Z with an optional offset, or as a bare offset like
+ * -0600 or +05:30. Returns false for anything else, including zone names like MST.
+ */
+static bool ParseZone(std::string_view zone, std::chrono::milliseconds& offset) {
+	for (std::string_view prefix : { "UTC", "GMT", "Z" }) {
+		if (zone.substr(0, prefix.size()) == prefix) {
+			zone.remove_prefix(prefix.size());
+			break;
+		}
+	}
+	if (zone.empty()) {
+		offset = std::chrono::milliseconds(0);
+		return true;
+	}
+	if (zone[0] != '+' && zone[0] != '-')
+		return false;
+	int sign = zone[0] == '-' ? -1 : 1;
+	zone.remove_prefix(1);
+	std::string digits;
+	for (size_t i = 0; i < zone.size(); i++) {
+		if (zone[i] == ':' && i > 0 && i < zone.size() - 1)
+			continue;
+		if (zone[i] < '0' || zone[i] > '9')
+			return false;
+		digits += zone[i];
+	}
+	int hours, minutes = 0;
+	if (digits.size() == 1 || digits.size() == 2)
+		hours = std::stoi(digits);
+	else if (digits.size() == 3 || digits.size() == 4) {
+		hours = std::stoi(digits.substr(0, digits.size() - 2));
+		minutes = std::stoi(digits.substr(digits.size() - 2));
+	}
+	else
+		return false;
+	if (hours > 23 || minutes > 59)
+		return false;
+	offset = std::chrono::hours(sign * hours) + std::chrono::minutes(sign * minutes);
+	return true;
+}
+
+/**
+ * Create a Java calendar at a time in the given time zone offset. Returns a local reference. Must
+ * be called from within a transaction.
+ */
+static jobject CalendarToJava(NativeJVM& jvm, Calendar::time_type time, std::chrono::milliseconds offset) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	jobject cal = jvm.CallStaticObjectMethod(priv.Class(JavaRegistry::Class::Calendar), priv.Method(JavaRegistry::Member::Calendar_getInstance), (jobject)nullptr);
+	jmethodID setTimeZone = priv.Method(JavaRegistry::Member::Calendar_setTimeZone);
+	if (offset.count() == 0)
+		jvm.CallMethod(cal, setTimeZone, priv.UtcTimeZone());
+	else {
+		jstring id = jvm.NewStringUTF(FormatZone(offset).c_str());
+		jobject timezone = jvm.CallStaticObjectMethod(priv.Class(JavaRegistry::Class::TimeZone), priv.Method(JavaRegistry::Member::TimeZone_getTimeZone), id);
+		jvm.CallMethod(cal, setTimeZone, timezone);
+		jvm.DeleteLocalRef(timezone);
+		jvm.DeleteLocalRef(id);
+	}
+	jvm.CallMethod(cal, priv.Method(JavaRegistry::Member::Calendar_setTimeInMillis), (jlong)time.time_since_epoch().count());
+	return cal;
+}
+
+Calendar::Calendar()
+	: JavaObject(0, JavaClassDef()),
+	m_time(std::chrono::floor<std::chrono::milliseconds>(std::chrono::system_clock::now())),
+	m_offset(0),
+	m_resolved(true) {
+	_type.name = "java/util/Calendar";
+}
+
+void Calendar::resolve() {
+	if (m_resolved)
+		return;
+	m_resolved = true;
+	m_time = time_type();
+	if (!_internal)
+		return;
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.transact([this, &priv](NativeJVM& jvm) {
+		jobject cal = (jobject)_internal;
+		jmethodID get = priv.Method(JavaRegistry::Member::Calendar_get);
+		m_time = time_type(std::chrono::milliseconds(jvm.CallLongMethod(cal, priv.Method(JavaRegistry::Member::Calendar_getTimeInMillis))));
+		m_offset = std::chrono::milliseconds(jvm.CallIntMethod(cal, get, (jint)CalendarType::ZONE_OFFSET) + jvm.CallIntMethod(cal, get, (jint)CalendarType::DST_OFFSET));
+	});
+}
+
+void Calendar::setField(int field, int value) {
+	resolve();
+	CalendarFields fields = SplitCalendar(m_time + m_offset);
+	*fields.field((CalendarType)field) = value;
+	setTime(JoinCalendar(fields) - m_offset);
+}
+
+int Calendar::getField(int field) {
+	resolve();
+	CalendarFields fields = SplitCalendar(m_time + m_offset);
+	return *fields.field((CalendarType)field);
+}
+
+void Calendar::setTime(time_type time) {
+	resolve();
+	m_time = time;
+	//the wrapped Java calendar no longer matches
+	dispose();
+}
+
+Calendar::time_type Calendar::getTime() {
+	resolve();
+	return m_time;
+}
+
+std::chrono::milliseconds Calendar::getZoneOffset() {
+	resolve();
+	return m_offset;
+}
+
+void Calendar::setYear(int year) {
+	setField((int)CalendarType::YEAR, year);
+}
+
+void Calendar::setMonth(int month) {
+	setField((int)CalendarType::MONTH, month);
+}
+
+void Calendar::setDay(int day) {
+	setField((int)CalendarType::DAY_OF_MONTH, day);
+}
+
+void Calendar::setHour(int hour) {
+	setField((int)CalendarType::HOUR_OF_DAY, hour);
+}
+
+void Calendar::setMinute(int min) {
+	setField((int)CalendarType::MINUTE, min);
+}
+
+void Calendar::setSeconds(int sec) {
+	setField((int)CalendarType::SECOND, sec);
+}
+
+void Calendar::setDateTime(int year, int month, int day, int hour, int min, int sec) {
+	resolve();
+	CalendarFields fields = SplitCalendar(m_time + m_offset);
+	fields.year = year;
+	fields.month = month;
+	fields.day = day;
+	fields.hour = hour;
+	fields.minute = min;
+	fields.second = sec;
+	setTime(JoinCalendar(fields) - m_offset);
+}
+
+Calendar::DateTime Calendar::getDateTime() {
+	resolve();
+	CalendarFields fields = SplitCalendar(m_time + m_offset);
+	return DateTime{ fields.year, fields.month, fields.day, fields.hour, fields.minute, fields.second };
+}
+
+int Calendar::getYear() {
+	return getField((int)CalendarType::YEAR);
+}
+
+int Calendar::getMonth() {
+	return getField((int)CalendarType::MONTH);
+}
+
+int Calendar::getDay() {
+	return getField((int)CalendarType::DAY_OF_MONTH);
+}
+
+int Calendar::getHour() {
+	return getField((int)CalendarType::HOUR_OF_DAY);
+}
+
+int Calendar::getMinute() {
+	return getField((int)CalendarType::MINUTE);
+}
+
+int Calendar::getSeconds() {
+	return getField((int)CalendarType::SECOND);
+}
+
+std::string Calendar::toString() {
+	resolve();
+	CalendarFields fields = SplitCalendar(m_time + m_offset);
+	char buffer[80];
+	snprintf(buffer, sizeof(buffer), "%04d%02d%02d%02d%02d%02d ", fields.year, fields.month + 1, fields.day, fields.hour, fields.minute, fields.second);
+	return buffer + FormatZone(m_offset);
+}
+
+bool Calendar::fromString(const std::string& val) {
+	resolve();
+	//yyyyMMddHHmmss z
+	std::string_view text(val);
+	std::chrono::milliseconds offset;
+	bool parsed = text.size() > 15 && text[14] == ' ' &&
+		std::all_of(text.begin(), text.begin() + 14, [](char c) { return c >= '0' && c <= '9'; }) &&
+		ParseZone(text.substr(15), offset);
+	if (parsed) {
+		auto number = [&text](size_t start, size_t length) { return std::stoi(std::string(text.substr(start, length))); };
+		CalendarFields fields{ number(0, 4), number(4, 2) - 1, number(6, 2), number(8, 2), number(10, 2), number(12, 2), 0 };
+		setTime(JoinCalendar(fields) - offset);
+		return true;
+	}
+
+	//time zone names need Java's time zone database
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	std::optional<time_type> time = priv.transact([&val, &priv](NativeJVM& jvm) -> std::optional<time_type> {
+		jstring format = jvm.NewStringUTF("yyyyMMddHHmmss z");
+		jstring text = jvm.NewStringUTF(val.c_str());
+		jobject formatter = jvm.NewObject(priv.Class(JavaRegistry::Class::SimpleDateFormat), priv.Method(JavaRegistry::Member::SimpleDateFormat_init), format);
+		jobject date = jvm.CallObjectMethodO(formatter, priv.Method(JavaRegistry::Member::SimpleDateFormat_parse), text);
+		std::optional<time_type> time;
+		//parse throws a ParseException if the text doesn't match the format
+		if (jvm.ExceptionCheck())
+			jvm.ExceptionClear();
+		else if (date) {
+			jobject cal = CalendarToJava(jvm, time_type(), std::chrono::milliseconds(0));
+			jvm.CallMethod(cal, priv.Method(JavaRegistry::Member::Calendar_setTime), date);
+			time = time_type(std::chrono::milliseconds(jvm.CallLongMethod(cal, priv.Method(JavaRegistry::Member::Calendar_getTimeInMillis))));
+			jvm.DeleteLocalRef(cal);
+			jvm.DeleteLocalRef(date);
+		}
+		jvm.DeleteLocalRef(formatter);
+		jvm.DeleteLocalRef(text);
+		jvm.DeleteLocalRef(format);
+		return time;
+	});
+	if (!time)
+		return false;
+	setTime(*time);
+	return true;
+}
+
+JavaWeatherStream::JavaWeatherStream()
+	 : JavaObject(0, JavaClassDef()) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	_type.name = "ca/wise/weather/WeatherCondition";
+	priv.transact([this, &priv](NativeJVM& jvm) {
+		_type.data = priv.Class(JavaRegistry::Class::WeatherCondition);
+		jmethodID mid = priv.Method(JavaRegistry::Member::WeatherCondition_init);
+		_internal = REDappWrapperPrivate::Pin(jvm, jvm.NewObject((jclass)_type.data, mid, (jobject)nullptr));
+	});
+	requiresDelete(true);
+}
+
+/**
+ * Deletes a Java reference when the last object sharing it is disposed, unless ownership was
+ * given up after the copies were made.
+ */
+struct JavaReferenceRelease {
+	bool armed{ true };
+
+	void operator()(void* ref) {
+		if (ref && armed)
+			REDappWrapperPrivate::get_mutable_instance().DeleteObject((jobject)ref);
+	}
+};
+
+void JavaObject::requiresDelete(bool del) {
+	if (del) {
+		if (_internal && !m_owner)
+			m_owner = std::shared_ptr<void>(_internal, JavaReferenceRelease());
+	}
+	else if (m_owner) {
+		if (JavaReferenceRelease* release = std::get_deleter<JavaReferenceRelease>(m_owner))
+			release->armed = false;
+		m_owner.reset();
+	}
+}
+
+void JavaObject::dispose() {
+	m_owner.reset();
+	_internal = nullptr;
+}
+
+void JavaWeatherStream::setLatitude(double latitude) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.transact([this, &priv, latitude](NativeJVM& jvm) {
+		jvm.CallMethod((jobject)_internal, priv.Method(JavaRegistry::Member::WeatherCondition_setLatitude), (jdouble)latitude);
+	});
+}
+
+void JavaWeatherStream::setLongitude(double longitude) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.transact([this, &priv, longitude](NativeJVM& jvm) {
+		jvm.CallMethod((jobject)_internal, priv.Method(JavaRegistry::Member::WeatherCondition_setLongitude), (jdouble)longitude);
+	});
+}
+
+void JavaWeatherStream::setTimezone(int64_t offset) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	m_timezone = offset;
+	priv.transact([this, &priv, offset](NativeJVM& jvm) {
+		jvm.CallMethod((jobject)_internal, priv.Method(JavaRegistry::Member::WeatherCondition_setTimezone), (jlong)offset);
+	});
+}
+
+void JavaWeatherStream::setDaylightSavings(int64_t amount) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	m_daylightSavings = amount;
+	priv.transact([this, &priv, amount](NativeJVM& jvm) {
+		jvm.CallMethod((jobject)_internal, priv.Method(JavaRegistry::Member::WeatherCondition_setDaylightSavings), (jlong)amount);
+	});
+}
+
+void JavaWeatherStream::setDaylightSavingsStart(int64_t offset) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.transact([this, &priv, offset](NativeJVM& jvm) {
+		jvm.CallMethod((jobject)_internal, priv.Method(JavaRegistry::Member::WeatherCondition_setDaylightSavingsStart), (jlong)offset);
+	});
+}
+
+void JavaWeatherStream::setDaylightSavingsEnd(int64_t offset) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.transact([this, &priv, offset](NativeJVM& jvm) {
+		jvm.CallMethod((jobject)_internal, priv.Method(JavaRegistry::Member::WeatherCondition_setDaylightSavingsEnd), (jlong)offset);
+	});
+}
+
+void JavaWeatherStream::configure(const StreamConfig& config) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	m_timezone = config.timezone;
+	m_daylightSavings = config.daylightSavings;
+	m_allowInvalid = config.allowInvalid;
+	m_parser = config.parser;
+	m_settingsKnown = true;
+	priv.transact([this, &priv, &config](NativeJVM& jvm) {
+		jobject stream = (jobject)_internal;
+		jvm.CallMethod(stream, priv.Method(JavaRegistry::Member::WeatherCondition_setLatitude), (jdouble)config.latitude);
+		jvm.CallMethod(stream, priv.Method(JavaRegistry::Member::WeatherCondition_setLongitude), (jdouble)config.longitude);
+		jvm.CallMethod(stream, priv.Method(JavaRegistry::Member::WeatherCondition_setTimezone), (jlong)config.timezone);
+		jvm.CallMethod(stream, priv.Method(JavaRegistry::Member::WeatherCondition_setDaylightSavings), (jlong)config.daylightSavings);
+		jvm.CallMethod(stream, priv.Method(JavaRegistry::Member::WeatherCondition_setDaylightSavingsStart), (jlong)config.daylightSavingsStart);
+		jvm.CallMethod(stream, priv.Method(JavaRegistry::Member::WeatherCondition_setDaylightSavingsEnd), (jlong)config.daylightSavingsEnd);
+	});
+}
+
+/**
+ * Copy the first count Java weather collections in a list one field at a time, handing each one
+ * to store along with its index. Must be called from within a transaction.
+ */
+template<typename _Store>
+static void ReadCollectionFields(NativeJVM& jvm, jobject list, size_t count, _Store&& store) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	jmethodID listGet = priv.Method(JavaRegistry::Member::List_get);
+	jfieldID hourFld = priv.Field(JavaRegistry::Member::WeatherCollection_hour);
+	jfieldID epochFld = priv.Field(JavaRegistry::Member::WeatherCollection_epoch);
+	jfieldID tempFld = priv.Field(JavaRegistry::Member::WeatherCollection_temp);
+	jfieldID rhFld = priv.Field(JavaRegistry::Member::WeatherCollection_rh);
+	jfieldID wdFld = priv.Field(JavaRegistry::Member::WeatherCollection_wd);
+	jfieldID wsFld = priv.Field(JavaRegistry::Member::WeatherCollection_ws);
+	jfieldID wgFld = priv.Field(JavaRegistry::Member::WeatherCollection_wg);
+	jfieldID precipFld = priv.Field(JavaRegistry::Member::WeatherCollection_precip);
+	jfieldID ffmcFld = priv.Field(JavaRegistry::Member::WeatherCollection_ffmc);
+	jfieldID DMCFld = priv.Field(JavaRegistry::Member::WeatherCollection_DMC);
+	jfieldID DCFld = priv.Field(JavaRegistry::Member::WeatherCollection_DC);
+	jfieldID BUIFld = priv.Field(JavaRegistry::Member::WeatherCollection_BUI);
+	jfieldID ISIFld = priv.Field(JavaRegistry::Member::WeatherCollection_ISI);
+	jfieldID FWIFld = priv.Field(JavaRegistry::Member::WeatherCollection_FWI);
+	jfieldID optionFld = priv.Field(JavaRegistry::Member::WeatherCollection_options);
+
+	//a Java list can't hold more than a jsize of entries, anything past that can't be read
+	jsize size = (jsize)std::min<size_t>(count, (size_t)std::numeric_limits<jsize>::max());
+	WeatherCollection row;
+	for (jsize i = 0; i < size; i++) {
+		jobject wc = jvm.CallObjectMethod(list, listGet, i);
+		row.hour = jvm.GetDoubleField(wc, hourFld);
+		row.epoch = (uint_fast64_t)jvm.GetLongField(wc, epochFld);
+		row.temp = jvm.GetDoubleField(wc, tempFld);
+		row.rh = jvm.GetDoubleField(wc, rhFld);
+		row.wd = jvm.GetDoubleField(wc, wdFld);
+		row.ws = jvm.GetDoubleField(wc, wsFld);
+		row.wg = jvm.GetDoubleField(wc, wgFld);
+		row.precip = jvm.GetDoubleField(wc, precipFld);
+		row.ffmc = jvm.GetDoubleField(wc, ffmcFld);
+		row.DMC = jvm.GetDoubleField(wc, DMCFld);
+		row.DC = jvm.GetDoubleField(wc, DCFld);
+		row.BUI = jvm.GetDoubleField(wc, BUIFld);
+		row.ISI = jvm.GetDoubleField(wc, ISIFld);
+		row.FWI = jvm.GetDoubleField(wc, FWIFld);
+		row.options = jvm.GetIntField(wc, optionFld);
+		jvm.DeleteLocalRef(wc);
+		store((size_t)i, row);
+	}
+}
+
+/**
+ * Copy a list of Java weather collections into a series. The series must already be the same size
+ * as the list. Must be called from within a transaction.
+ */
+static void ReadCollectionFields(NativeJVM& jvm, jobject list, WeatherSeries& out) {
+	ReadCollectionFields(jvm, list, out.size(), [&out](size_t i, const WeatherCollection& row) { out.set(i, row); });
+}
+
+/**
+ * The double columns written by BulkTransfer.weatherColumns, in the order they appear in the array,
+ * as series columns and as weather collection fields.
+ */
+static constexpr WeatherSeries::Column<double> WeatherSeries::* SeriesColumns[] = {
+	&WeatherSeries::hour,
+	&WeatherSeries::temp,
+	&WeatherSeries::rh,
+	&WeatherSeries::wd,
+	&WeatherSeries::ws,
+	&WeatherSeries::wg,
+	&WeatherSeries::precip,
+	&WeatherSeries::ffmc,
+	&WeatherSeries::DMC,
+	&WeatherSeries::DC,
+	&WeatherSeries::BUI,
+	&WeatherSeries::ISI,
+	&WeatherSeries::FWI
+};
+static constexpr double WeatherCollection::* CollectionColumns[] = {
+	&WeatherCollection::hour,
+	&WeatherCollection::temp,
+	&WeatherCollection::rh,
+	&WeatherCollection::wd,
+	&WeatherCollection::ws,
+	&WeatherCollection::wg,
+	&WeatherCollection::precip,
+	&WeatherCollection::ffmc,
+	&WeatherCollection::DMC,
+	&WeatherCollection::DC,
+	&WeatherCollection::BUI,
+	&WeatherCollection::ISI,
+	&WeatherCollection::FWI
+};
+static_assert(std::size(SeriesColumns) == std::size(CollectionColumns));
+
+/**
+ * Have the wrapper's Java adapter pack the first count weather collections in a list into
+ * primitive column arrays, so the whole list crosses JNI in a handful of bulk copies instead of one
+ * call per field. copy is handed the filled arrays. Returns false without calling copy if the
+ * adapter isn't loaded, bulk transfers are turned off or the list can't be packed. Must be called
+ * from within a transaction.
+ */
+template<typename _Copy>
+static bool PackCollectionColumns(NativeJVM& jvm, jobject list, size_t count, _Copy&& copy) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	constexpr size_t columns = std::size(SeriesColumns);
+	jmethodID weatherColumns = priv.BulkTransfers() ? priv.Method(JavaRegistry::Member::BulkTransfer_weatherColumns) : nullptr;
+	//every double column goes in one Java array so the lot has to fit in a jsize
+	if (!weatherColumns || count == 0 || count > (size_t)std::numeric_limits<jsize>::max() / columns)
+		return false;
+
+	jsize size = (jsize)count;
+	jdoubleArray values = nullptr;
+	jlongArray epochs = nullptr;
+	jintArray options = nullptr;
+	bool packed = (values = jvm.NewDoubleArray(size * (jsize)columns)) &&
+		(epochs = jvm.NewLongArray(size)) &&
+		(options = jvm.NewIntArray(size)) &&
+		jvm.CallStaticBooleanMethodOOOO(priv.Class(JavaRegistry::Class::BulkTransfer), weatherColumns, list, values, epochs, options);
+	if (jvm.ExceptionCheck()) {
+		jvm.ExceptionClear();
+		packed = false;
+	}
+	if (packed)
+		copy(values, epochs, options, size);
+
+	if (options)
+		jvm.DeleteLocalRef(options);
+	if (epochs)
+		jvm.DeleteLocalRef(epochs);
+	if (values)
+		jvm.DeleteLocalRef(values);
+	return packed;
+}
+
+/**
+ * Copy the first count Java weather collections in a list in bulk, handing each one to store along
+ * with its index. Returns false if the list couldn't be copied in bulk, in which case store hasn't
+ * been called. Must be called from within a transaction.
+ */
+template<typename _Store>
+static bool ReadCollectionColumns(NativeJVM& jvm, jobject list, size_t count, _Store&& store) {
+	return PackCollectionColumns(jvm, list, count, [&](jdoubleArray values, jlongArray epochs, jintArray options, jsize size) {
+		std::pmr::memory_resource* resource = REDappWrapperPrivate::get_const_instance().MemoryResource();
+		std::pmr::vector<jdouble> value((size_t)size * std::size(CollectionColumns), resource);
+		std::pmr::vector<jlong> epoch(size, resource);
+		std::pmr::vector<jint> option(size, resource);
+		jvm.GetDoubleArrayRegion(values, 0, (jsize)value.size(), value.data());
+		jvm.GetLongArrayRegion(epochs, 0, size, epoch.data());
+		jvm.GetIntArrayRegion(options, 0, size, option.data());
+		WeatherCollection row;
+		for (jsize i = 0; i < size; i++) {
+			for (size_t c = 0; c < std::size(CollectionColumns); c++)
+				row.*CollectionColumns[c] = value[c * size + i];
+			row.epoch = (uint_fast64_t)epoch[i];
+			row.options = option[i];
+			store((size_t)i, row);
+		}
+	});
+}
+
+/**
+ * Copy a list of Java weather collections into a series in bulk, each column straight into the
+ * series. The series must already be the same size as the list. Returns false if the list couldn't
+ * be copied in bulk, in which case the series hasn't been modified. Must be called from within a
+ * transaction.
+ */
+static bool ReadCollectionColumns(NativeJVM& jvm, jobject list, WeatherSeries& out) {
+	return PackCollectionColumns(jvm, list, out.size(), [&](jdoubleArray values, jlongArray epochs, jintArray options, jsize size) {
+		for (size_t c = 0; c < std::size(SeriesColumns); c++)
+			jvm.GetDoubleArrayRegion(values, (jsize)c * size, size, (out.*SeriesColumns[c]).data());
+		std::pmr::memory_resource* resource = out.epoch.get_allocator().resource;
+		std::pmr::vector<jlong> epoch(size, resource);
+		jvm.GetLongArrayRegion(epochs, 0, size, epoch.data());
+		std::copy(epoch.begin(), epoch.end(), out.epoch.begin());
+		std::pmr::vector<jint> option(size, resource);
+		jvm.GetIntArrayRegion(options, 0, size, option.data());
+		std::copy(option.begin(), option.end(), out.options.begin());
+	});
+}
+
+/**
+ * Run the Java hourly import on a weather stream. Returns a local reference to the list of
+ * imported hours, or nullptr if the import failed. Must be called from within a transaction.
+ */
+static jobject ImportHourlyList(NativeJVM& jvm, jobject stream, const std::string& filename, jint allowInvalid, long* hr) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	jclass outvarCls = priv.Class(JavaRegistry::Class::OutVariable);
+	jmethodID outvarinit = priv.Method(JavaRegistry::Member::OutVariable_init);
+	jobject outvar = jvm.NewObject(outvarCls, outvarinit, (jobject)nullptr);
+	jfieldID outvarvalue = priv.Field(JavaRegistry::Member::OutVariable_value);
+	jclass longCls = priv.Class(JavaRegistry::Class::Long);
+	jmethodID longInit = priv.Method(JavaRegistry::Member::Long_init);
+	jobject zerol = jvm.NewObject(longCls, longInit, (jlong)0);
+	jvm.SetObjectField(outvar, outvarvalue, zerol);
+	jstring f = jvm.NewStringUTF(filename.c_str());
+	jobject retval;
+	jmethodID ihMID = priv.Method(JavaRegistry::Member::WeatherCondition_importHourly);
+	if (ihMID == nullptr) {
+		ihMID = priv.Method(JavaRegistry::Member::WeatherCondition_importHourlyLegacy);
+		retval = jvm.CallObjectMethodOO(stream, ihMID, f, outvar);
+	}
+	else
+		retval = jvm.CallObjectMethodOOI(stream, ihMID, f, outvar, allowInvalid);
+	jobject hrjava = jvm.GetObjectField(outvar, outvarvalue);
+	jmethodID longGetLong = priv.Method(JavaRegistry::Member::Long_longValue);
+	*hr = (long)jvm.CallLongMethod(hrjava, longGetLong);
+
+	jvm.DeleteLocalRef(hrjava);
+	jvm.DeleteLocalRef(f);
+	jvm.DeleteLocalRef(outvar);
+	jvm.DeleteLocalRef(zerol);
+
+	if ((*hr == 0) || (*hr == 12803) || (*hr == 12805) || (*hr == (0x80000000 | 13)))
+		return retval;
+	if (retval)
+		jvm.DeleteLocalRef(retval);
+	return nullptr;
+}
+
+/**
+ * Run the Java hourly import on a weather stream and read the resulting hours into a series.
+ * Returns the result code from Java. Must be called from within a transaction.
+ */
+static long ImportHourlySeries(NativeJVM& jvm, jobject stream, const std::string& filename, jint allowInvalid, WeatherSeries& series) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	series.clear();
+	long hr;
+	jobject list = ImportHourlyList(jvm, stream, filename, allowInvalid, &hr);
+	if (list) {
+		int size = jvm.CallIntMethod(list, priv.Method(JavaRegistry::Member::List_size));
+		if (size > 0) {
+			series.resize(size);
+			if (!ReadCollectionColumns(jvm, list, series))
+				ReadCollectionFields(jvm, list, series);
+		}
+		jvm.DeleteLocalRef(list);
+	}
+	return hr;
+}
+
+WeatherCollection* JavaWeatherStream::importHourly(std::string& filename, long* hr, size_t* length) {
+	WeatherSeries series;
+	*hr = importHourly(filename, series);
+	*length = series.size();
+	if (series.empty())
+		return nullptr;
+	WeatherCollection* wcollection = new WeatherCollection[series.size()];
+	series.copyTo(wcollection);
+	return wcollection;
+}
+
+std::pmr::vector<WeatherCollection> JavaWeatherStream::importHourly(const std::string& filename, long* hr, std::pmr::memory_resource* resource) {
+	WeatherSeries series;
+	*hr = importHourly(filename, series);
+	std::pmr::vector<WeatherCollection> retval(series.size(), ResultResource(resource));
+	series.copyTo(retval.data());
+	return retval;
+}
+
+/**
+ * Check if two series hold exactly the same hours.
+ */
+static bool SameHours(const WeatherSeries& left, const WeatherSeries& right) {
+	return left.hour == right.hour && left.epoch == right.epoch && left.temp == right.temp &&
+		left.rh == right.rh && left.wd == right.wd && left.ws == right.ws && left.wg == right.wg &&
+		left.precip == right.precip && left.ffmc == right.ffmc && left.DMC == right.DMC &&
+		left.DC == right.DC && left.BUI == right.BUI && left.ISI == right.ISI && left.FWI == right.FWI &&
+		left.options == right.options;
+}
+
+long JavaWeatherStream::importHourly(const std::string& filename, WeatherSeries& series) {
+	typedef REDappWrapperPrivate::import_counters counters_t;
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	counters_t& counters = priv.ImportCounters();
+	auto importJava = [&](WeatherSeries& into) {
+		return priv.transactAny([&](NativeJVM& jvm) {
+			return ImportHourlySeries(jvm, (jobject)_internal, filename, (jint)m_allowInvalid, into);
+		});
+	};
+
+	if (m_parser == ImportParser::JAVA)
+		return importJava(series);
+
+	HourlyParser::Settings settings;
+	settings.timezone = m_timezone;
+	settings.daylightSavings = m_daylightSavings;
+	if (m_parser == ImportParser::NATIVE) {
+		counters_t::conformance_t conformance = counters.conformance.load(std::memory_order_acquire);
+		//the native parser never needs Java so it runs on the calling thread
+		if (conformance != counters_t::DIFFERS && m_settingsKnown && HourlyParser::parseFile(filename, settings, series)) {
+			if (conformance == counters_t::CONFORMS) {
+				counters.nativeImports.fetch_add(1, std::memory_order_relaxed);
+				return 0;
+			}
+			//until a native import has matched Java in this process the native result isn't
+			//trusted, the first one is imported through Java as well and native parsing is
+			//turned off if they differ
+			WeatherSeries java(series.hour.get_allocator().resource);
+			long hr = importJava(java);
+			counters.verified.fetch_add(1, std::memory_order_relaxed);
+			if (hr == 0 && SameHours(series, java)) {
+				counters_t::conformance_t expected = counters_t::UNCHECKED;
+				counters.conformance.compare_exchange_strong(expected, counters_t::CONFORMS, std::memory_order_acq_rel);
+				counters.nativeImports.fetch_add(1, std::memory_order_relaxed);
+				return 0;
+			}
+			counters.mismatches.fetch_add(1, std::memory_order_relaxed);
+			counters.conformance.store(counters_t::DIFFERS, std::memory_order_release);
+			series = std::move(java);
+			return hr;
+		}
+		counters.javaFallbacks.fetch_add(1, std::memory_order_relaxed);
+		return importJava(series);
+	}
+
+	WeatherSeries native(series.hour.get_allocator().resource);
+	bool parsed = m_settingsKnown && HourlyParser::parseFile(filename, settings, native);
+	long hr = importJava(series);
+	if (parsed) {
+		counters.verified.fetch_add(1, std::memory_order_relaxed);
+		if (hr != 0 || !SameHours(native, series))
+			counters.mismatches.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+		counters.javaFallbacks.fetch_add(1, std::memory_order_relaxed);
+	return hr;
+}
+
+std::vector<JavaWeatherStream::ImportResult> JavaWeatherStream::importHourlyMany(const std::vector<ImportSpec>& specs) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	std::vector<std::future<ImportResult>> pending;
+	pending.reserve(specs.size());
+	for (const ImportSpec& spec : specs) {
+		pending.push_back(priv.async([&spec]() {
+			ImportResult result;
+			JavaWeatherStream stream;
+			stream.configure(spec.config);
+			result.hr = stream.importHourly(spec.filename, result.series);
+			return result;
+		}));
+	}
+
+	std::vector<ImportResult> retval;
+	retval.reserve(specs.size());
+	for (std::future<ImportResult>& f : pending) {
+		try {
+			retval.push_back(f.get());
+		}
+		catch (...) {
+			ImportResult failed;
+			failed.hr = (long)0x80004005;	//E_FAIL
+			retval.push_back(std::move(failed));
+		}
+	}
+	return retval;
+}
+
+HourlyReader JavaWeatherStream::openHourly(const std::string& filename) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	long hr = 0;
+	size_t size = 0;
+	jobject list = priv.transactAny([&](NativeJVM& jvm) -> jobject {
+		jobject local = ImportHourlyList(jvm, (jobject)_internal, filename, (jint)m_allowInvalid, &hr);
+		if (!local)
+			return nullptr;
+		size = (size_t)std::max(jvm.CallIntMethod(local, priv.Method(JavaRegistry::Member::List_size)), 0);
+		return REDappWrapperPrivate::Pin(jvm, local);
+	});
+	return HourlyReader(list, size, hr);
+}
+
+HourlyReader::HourlyReader(HourlyReader&& other) noexcept
+	: m_list(std::exchange(other.m_list, nullptr)),
+	m_remaining(std::exchange(other.m_remaining, 0)),
+	m_offset(other.m_offset),
+	m_hr(other.m_hr),
+	m_shrink(other.m_shrink) {
+}
+
+HourlyReader& HourlyReader::operator=(HourlyReader&& other) noexcept {
+	if (this != &other) {
+		close();
+		m_list = std::exchange(other.m_list, nullptr);
+		m_remaining = std::exchange(other.m_remaining, 0);
+		m_offset = other.m_offset;
+		m_hr = other.m_hr;
+		m_shrink = other.m_shrink;
+	}
+	return *this;
+}
+
+HourlyReader::~HourlyReader() {
+	close();
+}
+
+void HourlyReader::close() {
+	if (m_list) {
+		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+		priv.DeleteObject((jobject)m_list);
+		m_list = nullptr;
+	}
+	m_remaining = 0;
+}
+
+size_t HourlyReader::read(WeatherCollection* buffer, size_t capacity) {
+	return read(capacity, nullptr, buffer);
+}
+
+size_t HourlyReader::read(WeatherSeries& chunk, size_t capacity) {
+	return read(capacity, &chunk, nullptr);
+}
+
+size_t HourlyReader::read(size_t capacity, WeatherSeries* series, WeatherCollection* buffer) {
+	size_t count = std::min(capacity, m_remaining);
+	if (series)
+		series->resize(count);
+	if (count == 0)
+		return 0;
+
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.transactAny([&](NativeJVM& jvm) {
+		jobject sub = jvm.CallObjectMethodII((jobject)m_list, priv.Method(JavaRegistry::Member::List_subList), (jint)m_offset, (jint)(m_offset + count));
+		auto store = [buffer](size_t i, const WeatherCollection& row) { buffer[i] = row; };
+		if (series) {
+			if (!ReadCollectionColumns(jvm, sub, *series))
+				ReadCollectionFields(jvm, sub, *series);
+		}
+		else if (!ReadCollectionColumns(jvm, sub, count, store))
+			ReadCollectionFields(jvm, sub, count, store);
+		//clearing the sub list removes the hours from the full list so Java can collect them,
+		//if the list can't be modified fall back to stepping through it
+		if (m_shrink) {
+			jvm.CallMethod(sub, priv.Method(JavaRegistry::Member::List_clear), (jobject)nullptr);
+			if (jvm.ExceptionCheck()) {
+				jvm.ExceptionClear();
+				m_shrink = false;
+			}
+		}
+		if (!m_shrink)
+			m_offset += count;
+		jvm.DeleteLocalRef(sub);
+	});
+
+	m_remaining -= count;
+	if (m_remaining == 0) {
+		priv.DeleteObject((jobject)m_list);
+		m_list = nullptr;
+	}
+	return count;
+}
+
+HourlyImport JavaWeatherStream::importHourlyNow(std::string filename) {
+	HourlyImport retval;
+	retval.hr = importHourly(filename, retval.series);
+	return retval;
+}
+
+std::future<HourlyImport> JavaWeatherStream::importHourlyAsync(const std::string& filename) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	return priv.async([this, filename]() { return importHourlyNow(filename); });
+}
+
+void JavaWeatherStream::importHourlyAsync(const std::string& filename, Completion<HourlyImport> callback) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.async([this, filename]() { return importHourlyNow(filename); }, std::move(callback));
+}
+
+Awaitable<HourlyImport> JavaWeatherStream::importHourlyAwait(const std::string& filename, Executor executor) {
+	return Awaitable<HourlyImport>([this, filename](Completion<HourlyImport> done) {
+		importHourlyAsync(filename, std::move(done));
+	}, std::move(executor));
+}
+
+ForecastCalculator::ForecastCalculator()
+	 : JavaObject(0, JavaClassDef()),
+	   m_location(nullptr, JavaClassDef()) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	_type.name = "ca/weather/acheron/Calculator";
+	priv.transact([this, &priv](NativeJVM& jvm) {
+		_type.data = priv.Class(JavaRegistry::Class::Calculator);
+		jmethodID mid = priv.Method(JavaRegistry::Member::Calculator_init);
+		_internal = REDappWrapperPrivate::Pin(jvm, jvm.NewObject((jclass)_type.data, mid, (jobject)nullptr));
+	});
+	requiresDelete(true);
+	m_model = Model::GEM_DETER;
+	m_timezone = 0;
+	m_hack50 = -1;
+}
+
+ForecastCalculator::ForecastCalculator(const std::string& stream)
+	: JavaObject(0, JavaClassDef()),
+	m_location(nullptr, JavaClassDef()) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	_type.name = "ca/weather/acheron/Calculator";
+	_type.data = priv.transact([&priv](NativeJVM&) { return priv.Class(JavaRegistry::Class::Calculator); });
+}
+
+
+#if !defined(__INTEL_COMPILER) && !defined(__INTEL_LLVM_COMPILER)
+static const int ForecastCalculatorVersion = 1;
+#else
+static constexpr int ForecastCalculatorVersion = 1;
+#endif
+
+std::string ForecastCalculator::toStreamable() {
+	std::stringstream stream;
+	stream << std::string("ACHERON;");
+	stream << ForecastCalculatorVersion;
+	stream << ";" << (short int)m_model << ";" << m_location.locationName() << ";" << m_timezone << ";" << m_date.toString() << ";" << (short int)m_time << ";";
+	for (int i : m_members) {
+		stream << i << ";";
 	}
+	return stream.str();
 }
 
-jfieldID REDappWrapperPrivate::GetStaticField(REDapp::JavaClassDef& cls, const std::string& name, const std::string& sig) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jfieldID retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,name,sig,this]{
-			retval = m_fieldCache.createStatic((jclass)cls.data, cls.name, name, sig, m_jvm.get());
-		};
-		run(job);
-		return retval;
+struct semicolon_is_space : std::ctype<char> {
+	semicolon_is_space() : std::ctype<char>(get_table()) { }
+	static mask const* get_table() {
+		static mask rc[table_size];
+		rc[';'] = std::ctype_base::space;
+		return &rc[0];
 	}
-	return nullptr;
+};
+
+void ForecastCalculator::fromStreamable(std::string str) {
+	throw NotImplementedException();
+	std::stringstream stream(str);
+	stream.imbue(std::locale(stream.getloc(), new semicolon_is_space));
 }
 
-jfieldID REDappWrapperPrivate::GetStaticField(jclass cls, const std::string& clsname, const std::string& name, const std::string& sig) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jfieldID retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,clsname,name,sig,this]{
-			retval = m_fieldCache.createStatic(cls, clsname, name, sig, m_jvm.get());
-		};
-		run(job);
-		return retval;
+/**
+ * Push a forecast's settings into a Java calculator for one location and run it. Returns a pinned
+ * reference to the location's weather, or nullptr if the calculation failed. Must be called from
+ * within a transaction.
+ */
+static jobject RunCalculator(NativeJVM& jvm, jobject calculator, jstring name, REDapp::Model model, Time time,
+		const std::vector<int>& members, jobject date, int percentile) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	jmethodID setLocation = priv.Method(JavaRegistry::Member::Calculator_setLocation);
+	jvm.CallMethod(calculator, setLocation, name);
+	jmethodID setModel = priv.Method(JavaRegistry::Member::Calculator_setModel);
+	jvm.CallMethod(calculator, setModel, ModelToJava(model));
+	jmethodID setTime = priv.Method(JavaRegistry::Member::Calculator_setTime);
+	jvm.CallMethod(calculator, setTime, TimeToJava(time));
+	if (model == REDapp::Model::CUSTOM) {
+		jmethodID clearMembers = priv.Method(JavaRegistry::Member::Calculator_clearMembers);
+		jvm.CallMethod(calculator, clearMembers, (jobject)nullptr);
+		jmethodID addMember = priv.Method(JavaRegistry::Member::Calculator_addMember);
+		for (int member : members) {
+			jvm.CallMethod(calculator, addMember, (jint)member);
+		}
+	}
+	jclass WorldLocationClass = priv.Class(JavaRegistry::Class::WorldLocation);
+	jmethodID getTimeZoneFromOffset = priv.Method(JavaRegistry::Member::WorldLocation_getTimeZoneFromOffset);
+	jint zero = 0;
+	jobject timezone = jvm.CallStaticObjectMethod(WorldLocationClass, getTimeZoneFromOffset, zero);
+	jmethodID setTimezone = priv.Method(JavaRegistry::Member::Calculator_setTimezone);
+	jvm.CallMethod(calculator, setTimezone, timezone);
+	jvm.DeleteLocalRef(timezone);
+	jmethodID setDate = priv.Method(JavaRegistry::Member::Calculator_setDate);
+	jvm.CallMethod(calculator, setDate, date);
+	if (percentile > 0 && percentile < 100) {
+		jmethodID setperc = priv.Method(JavaRegistry::Member::Calculator_setPercentile);
+		jvm.CallMethod(calculator, setperc, (jint)percentile);
+	}
+	jmethodID calculate = priv.Method(JavaRegistry::Member::Calculator_calculate);
+	if (jvm.CallBooleanMethod(calculator, calculate)) {
+		jint index = 0;
+		jmethodID getLocationsWeatherData = priv.Method(JavaRegistry::Member::Calculator_getLocationsWeatherData);
+		return REDappWrapperPrivate::Pin(jvm, jvm.CallObjectMethod(calculator, getLocationsWeatherData, index));
 	}
 	return nullptr;
 }
 
-jobject REDappWrapperPrivate::GetStaticObjectField(jclass cls, jfieldID fid) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,fid,this]{
-			retval = m_jvm->GetStaticObjectField(cls, fid);
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+struct LocationHours : public ForecastHours {
+	std::once_flag loaded;
+	/**
+	 * The hours hold a forecast, either copied out of Java or found in the forecast cache.
+	 */
+	bool valid{ false };
+};
+
+/**
+ * The canonical form of the parameters that decide a forecast, used as its key in the forecast cache.
+ * Members only count for custom ensembles and the percentile only when it's used. Returns an empty
+ * key, so the forecast isn't cached, if the location's province isn't known since names can repeat
+ * across provinces.
+ */
+static std::string ForecastKey(const std::string& location, std::optional<Province> province, REDapp::Model model, Calendar::time_type date,
+		std::chrono::milliseconds offset, Time time, const std::vector<int>& members, int percentile) {
+	if (!province)
+		return std::string();
+	std::ostringstream key;
+	key << "location=" << location << "\n";
+	key << "province=" << (int)*province << "\n";
+	key << "model=" << (int)model << "\n";
+	key << "date=" << date.time_since_epoch().count() << "\n";
+	key << "offset=" << offset.count() << "\n";
+	key << "time=" << (int)time << "\n";
+	key << "percentile=" << (percentile > 0 && percentile < 100 ? percentile : -1) << "\n";
+	key << "members=";
+	if (model == REDapp::Model::CUSTOM) {
+		for (int member : members)
+			key << member << ",";
+	}
+	return key.str();
 }
 
-jmethodID REDappWrapperPrivate::GetMethod(REDapp::JavaClassDef& cls, const std::string& name, const std::string& sig) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jmethodID retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,name,sig,this]{
-			retval = m_methodCache.create((jclass)cls.data, cls.name, name, sig, m_jvm.get());
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+/**
+ * Look a forecast up in the forecast cache. Returns nullptr if it isn't cached.
+ */
+static std::shared_ptr<LocationHours> CachedHours(ForecastCache& cache, const std::string& key) {
+	std::shared_ptr<const ForecastHours> found = cache.find(key);
+	if (!found)
+		return nullptr;
+	auto hours = std::make_shared<LocationHours>();
+	hours->hours = found->hours;
+	hours->times = found->times;
+	hours->valid = true;
+	return hours;
 }
 
-jmethodID REDappWrapperPrivate::GetMethod(jclass cls, const std::string& clsname, const std::string& name, const std::string& sig) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jmethodID retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,clsname,name,sig,this]{
-			retval = m_methodCache.create(cls, clsname, name, sig, m_jvm.get());
-		};
-		run(job);
-		return retval;
+LocationWeatherGC ForecastCalculator::getWeather(bool* success) {
+	if (m_location.isValid()) {
+		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+		ForecastCache& cache = priv.Forecasts();
+		std::string key;
+		if (cache.enabled()) {
+			key = ForecastKey(m_location.locationName(), m_location.m_province, m_model, m_date.getTime(), m_date.getZoneOffset(), m_time, m_members, m_hack50);
+			if (std::shared_ptr<LocationHours> hours = key.empty() ? nullptr : CachedHours(cache, key)) {
+				*success = true;
+				return LocationWeatherGC(hours);
+			}
+		}
+		JavaClassDef def = { nullptr, "ca/weather/acheron/LocationWeather" };
+		jobject weather = priv.transactAny([this, &def, &priv](NativeJVM& jvm) -> jobject {
+			def.data = priv.Class(JavaRegistry::Class::LocationWeather);
+			jfieldID fid = priv.Field(JavaRegistry::Member::LocationSmall_locationName);
+			jstring name = (jstring)jvm.GetObjectField((jobject)m_location._internal, fid);
+			//a calendar that still wraps an unmodified Java calendar can be passed straight through
+			jobject date = m_date._internal ? nullptr : CalendarToJava(jvm, m_date.getTime(), m_date.getZoneOffset());
+			jobject weather = RunCalculator(jvm, (jobject)_internal, name, m_model, m_time, m_members, date ? date : (jobject)m_date._internal, m_hack50);
+			if (date)
+				jvm.DeleteLocalRef(date);
+			jvm.DeleteLocalRef(name);
+			return weather;
+		});
+		if (weather) {
+			*success = true;
+			//copy the hours out while the forecast is still warm rather than on first access
+			LocationWeatherGC retval(weather, def);
+			retval.requiresDelete(true);
+			retval.hours();
+			if (!key.empty() && retval.m_hours->valid)
+				cache.insert(key, retval.m_hours);
+			return retval;
+		}
 	}
-	return nullptr;
+	*success = false;
+	return LocationWeatherGC(0, JavaClassDef());
 }
 
-jobject REDappWrapperPrivate::GetArrayElement(jobject obj, int* size, int index) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,obj,size,index,this]{
-			if (size != nullptr)
-				*size = m_jvm->GetArrayLength((jarray)obj);
-			if (index >= 0)
-				retval = m_jvm->GetObjectArrayElement((jobjectArray)obj, index);
-		};
-		run(job);
-		return retval;
+std::map<std::string, LocationWeatherGC> ForecastCalculator::getWeatherMany(const std::vector<LocationSmall>& locations) {
+	struct result_t {
+		std::string name;
+		std::optional<Province> province;
+		LocationWeatherGC weather;
+	};
+	typedef std::vector<result_t> results_t;
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	std::vector<const LocationSmall*> valid;
+	for (const LocationSmall& location : locations) {
+		if (location._internal)
+			valid.push_back(&location);
 	}
-	return nullptr;
-}
+	std::map<std::string, LocationWeatherGC> retval;
+	if (valid.empty())
+		return retval;
 
-std::string REDappWrapperPrivate::GetJStringContent(jstring str) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		std::string retval;
-		WorkerThread::job_t job = [&retval,str,this]{
-			if (!str)
-				retval.clear();
+	Calendar::time_type time = m_date.getTime();
+	std::chrono::milliseconds offset = m_date.getZoneOffset();
+	ForecastCache& cache = priv.Forecasts();
+	if (cache.enabled()) {
+		std::vector<const LocationSmall*> uncached;
+		for (const LocationSmall* location : valid) {
+			std::string name = const_cast<LocationSmall*>(location)->locationName();
+			std::string key = ForecastKey(name, location->m_province, m_model, time, offset, m_time, m_members, m_hack50);
+			if (std::shared_ptr<LocationHours> hours = key.empty() ? nullptr : CachedHours(cache, key))
+				retval.emplace(name, LocationWeatherGC(hours));
 			else
-			{
-				const char *s = m_jvm->GetStringUTFChars(str);
-				retval = s;
-				m_jvm->ReleaseStringUTFChars(str, s);
+				uncached.push_back(location);
+		}
+		valid.swap(uncached);
+		if (valid.empty())
+			return retval;
+	}
+	auto add = [&](results_t& results) {
+		for (result_t& result : results) {
+			if (cache.enabled()) {
+				std::string key = ForecastKey(result.name, result.province, m_model, time, offset, m_time, m_members, m_hack50);
+				if (!key.empty() && result.weather.m_hours->valid)
+					cache.insert(key, result.weather.m_hours);
 			}
-		};
-		run(job);
-		return retval;
+			retval.emplace(std::move(result.name), std::move(result.weather));
+		}
+	};
+	//run the locations in [first, last) on a calculator of their own, so jobs never share one
+	auto run = [this, &priv, &valid, time, offset](size_t first, size_t last, size_t step) {
+		results_t results;
+		priv.transactAny([&](NativeJVM& jvm) {
+			JavaClassDef def = { priv.Class(JavaRegistry::Class::LocationWeather), "ca/weather/acheron/LocationWeather" };
+			jobject calculator = jvm.NewObject(priv.Class(JavaRegistry::Class::Calculator), priv.Method(JavaRegistry::Member::Calculator_init), (jobject)nullptr);
+			jobject date = CalendarToJava(jvm, time, offset);
+			jfieldID fid = priv.Field(JavaRegistry::Member::LocationSmall_locationName);
+			for (size_t i = first; i < last; i += step) {
+				jstring name = (jstring)jvm.GetObjectField((jobject)valid[i]->_internal, fid);
+				jobject weather = RunCalculator(jvm, calculator, name, m_model, m_time, m_members, date, m_hack50);
+				if (weather) {
+					results.push_back(result_t{ JStringContent(jvm, name), valid[i]->m_province, LocationWeatherGC(weather, def) });
+					results.back().weather.requiresDelete(true);
+				}
+				jvm.DeleteLocalRef(name);
+			}
+			jvm.DeleteLocalRef(date);
+			jvm.DeleteLocalRef(calculator);
+		});
+		for (result_t& result : results)
+			result.weather.hours();
+		return results;
+	};
+
+	//the first location runs alone so the model data it downloads is in place before the
+	//rest of the locations start on the other workers
+	results_t first = run(0, 1, 1);
+	add(first);
+
+	//jobs that would run inline one after another share a single calculator
+	size_t jobs = priv.asyncInline() ? 1 : std::min(priv.PoolSize(), valid.size() - 1);
+	std::vector<std::future<results_t>> pending;
+	pending.reserve(jobs);
+	for (size_t j = 0; j < jobs; j++)
+		pending.push_back(priv.async([&run, &valid, j, jobs]() { return run(1 + j, valid.size(), jobs); }));
+
+	//wait for every job before rethrowing so none are left reading the locations
+	std::exception_ptr error;
+	for (std::future<results_t>& f : pending) {
+		try {
+			results_t results = f.get();
+			add(results);
+		}
+		catch (...) {
+			if (!error)
+				error = std::current_exception();
+		}
 	}
-	return std::string("");
+	if (error)
+		std::rethrow_exception(error);
+	return retval;
 }
 
-jstring REDappWrapperPrivate::GetJString(std::string str) {
-	jstring retval;
-	WorkerThread::job_t job = [&retval,str,this]{
-		retval = m_jvm->NewStringUTF(str.c_str());
-	};
-	run(job);
-	return retval;
+std::future<LocationWeatherGC> ForecastCalculator::getWeatherAsync() {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	return priv.async([this]() { bool success; return getWeather(&success); });
 }
 
-void REDappWrapperPrivate::FreeJString(jstring str) {
-	WorkerThread::job_t job = [str,this]{
-		m_jvm->DeleteLocalRef(str);
-	};
-	run(job);
+void ForecastCalculator::getWeatherAsync(Completion<LocationWeatherGC> callback) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	priv.async([this]() { bool success; return getWeather(&success); }, std::move(callback));
 }
 
-jobject REDappWrapperPrivate::NewObject(jclass cls, jmethodID constructor, jobject param) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,constructor,param,this]{
-			retval = m_jvm->NewObject(cls, constructor, param);
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+Awaitable<LocationWeatherGC> ForecastCalculator::getWeatherAwait(Executor executor) {
+	return Awaitable<LocationWeatherGC>([this](Completion<LocationWeatherGC> done) {
+		getWeatherAsync(std::move(done));
+	}, std::move(executor));
 }
 
-void REDappWrapperPrivate::DeleteObject(jobject obj) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		WorkerThread::job_t job = [obj, this] {
-			m_jvm->DeleteLocalRef(obj);
-		};
-		run(job);
+/**
+ * Copy a window of a list of Java hours into weather data one hour at a time, jumping straight to
+ * the start of the window with List.get. Must be called from within a transaction.
+ */
+static void ReadHourFields(NativeJVM& jvm, jobject list, jint start, jint count, IWXData* data) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	jmethodID listGet = priv.Method(JavaRegistry::Member::List_get);
+	jmethodID getTemperature = priv.Method(JavaRegistry::Member::Hour_getTemperature);
+	jmethodID getRelativeHumidity = priv.Method(JavaRegistry::Member::Hour_getRelativeHumidity);
+	jmethodID getPrecipitation = priv.Method(JavaRegistry::Member::Hour_getPrecipitation);
+	jmethodID getWindSpeed = priv.Method(JavaRegistry::Member::Hour_getWindSpeed);
+	jmethodID getWindDirection = priv.Method(JavaRegistry::Member::Hour_getWindDirection);
+	jmethodID getInterpolated = priv.Method(JavaRegistry::Member::Hour_isInterpolated);
+	for (jint i = 0; i < count; i++) {
+		jobject hour = jvm.CallObjectMethod(list, listGet, start + i);
+		data[i].Temperature = jvm.CallDoubleMethod(hour, getTemperature);
+		data[i].RH = jvm.CallDoubleMethod(hour, getRelativeHumidity) / 100.0;
+		data[i].Precipitation = jvm.CallDoubleMethod(hour, getPrecipitation);
+		data[i].WindSpeed = jvm.CallDoubleMethod(hour, getWindSpeed);
+		data[i].WindDirection = jvm.CallDoubleMethod(hour, getWindDirection);
+		data[i].SpecifiedBits = jvm.CallBooleanMethod(hour, getInterpolated) ? 0x00000040 : 0;
+		jvm.DeleteLocalRef(hour);
 	}
 }
 
-jobject REDappWrapperPrivate::NewObject(jclass cls, jmethodID constructor, jlong lval) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,constructor,lval,this]{
-			retval = m_jvm->NewObject(cls, constructor, lval);
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+/**
+ * Get the time of one of the hours in a forecast list in milliseconds since the epoch. Must be called
+ * from within a transaction.
+ */
+static std::int64_t HourTime(NativeJVM& jvm, jobject list, jint index) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	jobject hour = jvm.CallObjectMethod(list, priv.Method(JavaRegistry::Member::List_get), index);
+	jobject cal = jvm.CallObjectMethodO(hour, priv.Method(JavaRegistry::Member::Hour_getCalendarDate), nullptr);
+	std::int64_t time = jvm.CallLongMethod(cal, priv.Method(JavaRegistry::Member::Calendar_getTimeInMillis));
+	jvm.DeleteLocalRef(cal);
+	jvm.DeleteLocalRef(hour);
+	return time;
 }
 
-jintArray REDappWrapperPrivate::NewIntArray(int size) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jintArray retval = nullptr;
-		WorkerThread::job_t job = [&retval,size,this]{
-			retval = m_jvm->NewIntArray(size);
-		};
-		run(job);
-		return retval;
+/**
+ * Copy every hour of a forecast out of Java. Must be called from within a transaction.
+ * @returns false if the forecast has no hour data to copy.
+ */
+static bool LoadLocationHours(NativeJVM& jvm, jobject weather, LocationHours& out) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	jobject list = jvm.CallObjectMethodO(weather, priv.Method(JavaRegistry::Member::LocationWeather_getHourData), nullptr);
+	if (jvm.ExceptionCheck()) {
+		jvm.ExceptionClear();
+		return false;
 	}
-	return nullptr;
+	if (!list)
+		return false;
+	jint length = std::max(jvm.CallIntMethod(list, priv.Method(JavaRegistry::Member::List_size)), 0);
+	out.hours.resize(length);
+	out.times.resize(length);
+	if (length > 0) {
+		ReadHourFields(jvm, list, 0, length, out.hours.data());
+		for (jint i = 0; i < length; i++)
+			out.times[i] = HourTime(jvm, list, i);
+	}
+	jvm.DeleteLocalRef(list);
+	return true;
 }
 
-jdoubleArray REDappWrapperPrivate::NewDoubleArray(int size) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jdoubleArray retval = nullptr;
-		WorkerThread::job_t job = [&retval,size,this]{
-			retval = m_jvm->NewDoubleArray(size);
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+LocationWeatherGC::LocationWeatherGC(void* internal, JavaClassDef type)
+	: LocationWeather(internal, type),
+	m_hours(std::make_shared<LocationHours>()) {
 }
 
-jobjectArray REDappWrapperPrivate::NewObjectArray(int size, jclass cls) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		jobjectArray retval = nullptr;
-		WorkerThread::job_t job = [&retval,size,cls,this]{
-			retval = m_jvm->NewObjectArray(size, cls);
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+LocationWeatherGC::LocationWeatherGC(std::shared_ptr<LocationHours> hours)
+	: LocationWeather(nullptr, JavaClassDef()),
+	m_hours(std::move(hours)) {
+	_type.name = "ca/weather/acheron/LocationWeather";
 }
 
-int REDappWrapperPrivate::SetIntField(jobject obj, jfieldID fld, jint val) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		WorkerThread::job_t job = [obj,fld,val,this]{
-			m_jvm->SetIntField(obj, fld, val);
-		};
-		run(job);
-		return JNI_OK;
-	}
-	return JNI_ERR;
+bool LocationWeatherGC::isValid() {
+	return JavaObject::isValid() || m_hours->valid;
 }
 
-int REDappWrapperPrivate::SetDoubleField(jobject obj, jfieldID fld, jdouble val) {
-	init();
-	if (m_jvm->IsValid())
-	{
-		WorkerThread::job_t job = [obj,fld,val,this]{
-			m_jvm->SetDoubleField(obj, fld, val);
-		};
-		run(job);
-		return JNI_OK;
-	}
-	return JNI_ERR;
+const LocationHours& LocationWeatherGC::hours() {
+	std::call_once(m_hours->loaded, [this]() {
+		if (!_internal)
+			return;
+		REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+		bool loaded = priv.transactAny([this](NativeJVM& jvm) {
+			return LoadLocationHours(jvm, (jobject)_internal, *m_hours);
+		});
+		if (loaded) {
+			m_hours->valid = true;
+			//everything needed is in m_hours now so the Java forecast doesn't need to stay pinned
+			dispose();
+		}
+	});
+	return *m_hours;
 }
 
-int REDappWrapperPrivate::SetLongField(jobject obj, jfieldID fld, jlong val) {
-	init();
-	if (m_jvm->IsValid()) {
-		WorkerThread::job_t job = [obj,fld,val,this]{
-			m_jvm->SetLongField(obj, fld, val);
-		};
-		run(job);
-		return JNI_OK;
-	}
-	return JNI_ERR;
+void LocationWeatherGC::getWeather(IWXData* data, size_t* size, size_t offset) {
+	const std::vector<IWXData>& all = hours().hours;
+	size_t count = offset < all.size() ? std::min(*size, all.size() - offset) : 0;
+	std::copy_n(all.begin() + offset, count, data);
+	*size = count;
 }
 
-int REDappWrapperPrivate::SetObjectField(jobject obj, jfieldID fld, jobject val) {
-	init();
-	if (m_jvm->IsValid()) {
-		WorkerThread::job_t job = [obj,fld,val,this]{
-			m_jvm->SetObjectField(obj, fld, val);
-		};
-		run(job);
-		return JNI_OK;
-	}
-	return JNI_ERR;
+void LocationWeatherGC::getTimes(std::int64_t* times, size_t* size, size_t offset) {
+	const std::vector<std::int64_t>& all = hours().times;
+	size_t count = offset < all.size() ? std::min(*size, all.size() - offset) : 0;
+	std::copy_n(all.begin() + offset, count, times);
+	*size = count;
 }
 
-int REDappWrapperPrivate::SetObjectArrayElement(jobjectArray arr, int index, jobject val) {
-	init();
-	if (m_jvm->IsValid()) {
-		WorkerThread::job_t job = [arr,index,val,this]{
-			m_jvm->SetObjectArrayElement(arr, index, val);
-		};
-		run(job);
-		return JNI_OK;
-	}
-	return JNI_ERR;
+Calendar LocationWeatherGC::startDate() {
+	const std::vector<std::int64_t>& times = hours().times;
+	return Calendar(Calendar::time_type(std::chrono::milliseconds(times.empty() ? 0 : times.front())));
 }
 
-jfieldID REDappWrapperPrivate::GetField(REDapp::JavaClassDef& cls, const std::string& name, const std::string& sig) {
-	init();
-	if (m_jvm->IsValid()) {
-		jfieldID retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,name,sig,this]{
-			retval = m_fieldCache.create((jclass)cls.data, cls.name, name, sig, m_jvm.get());
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+size_t LocationWeatherGC::size() {
+	return hours().hours.size();
 }
 
-jfieldID REDappWrapperPrivate::GetField(jclass cls, const std::string& clsname, const std::string& name, const std::string& sig) {
-	init();
-	if (m_jvm->IsValid()) {
-		jfieldID retval = nullptr;
-		WorkerThread::job_t job = [&retval,cls,clsname,name,sig,this]{
-			retval = m_fieldCache.create(cls, clsname, name, sig, m_jvm.get());
-		};
-		run(job);
+const std::string LocationSmall::locationName() {
+	if (!m_name.empty())
+		return m_name;
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	return priv.transact([this, &priv](NativeJVM& jvm) {
+		jstring str = (jstring)jvm.GetObjectField((jobject)_internal, priv.Field(JavaRegistry::Member::LocationSmall_locationName));
+		std::string retval = JStringContent(jvm, str);
+		jvm.DeleteLocalRef(str);
 		return retval;
-	}
-	return nullptr;
+	});
 }
 
-jobject REDappWrapperPrivate::CallObjectField(jobject obj, jfieldID fid) {
-	init();
-	if (m_jvm->IsValid()) {
-		jobject retval = nullptr;
-		WorkerThread::job_t job = [&retval,obj,fid,this]{
-			retval = m_jvm->GetObjectField(obj, fid);
-		};
-		run(job);
-		return retval;
-	}
-	return nullptr;
+STANDARD_STRING_GETTER(GCWeather, CurrentWeather, Observed)
+STANDARD_DOUBLE_GETTER(GCWeather, CurrentWeather, Temperature)
+STANDARD_DOUBLE_GETTER(GCWeather, CurrentWeather, Pressure)
+STANDARD_DOUBLE_GETTER(GCWeather, CurrentWeather, Visibility)
+STANDARD_DOUBLE_GETTER(GCWeather, CurrentWeather, Humidity)
+STANDARD_DOUBLE_GETTER(GCWeather, CurrentWeather, Windchill)
+STANDARD_DOUBLE_GETTER(GCWeather, CurrentWeather, Dewpoint)
+STANDARD_STRING_GETTER(GCWeather, CurrentWeather, WindDirection)
+STANDARD_DOUBLE_GETTER(GCWeather, CurrentWeather, WindSpeed)
 }
 
-jint REDappWrapperPrivate::CallIntField(jobject obj, jfieldID fid) {
-	init();
+/// Initialize Java.
+/// Adds the Java bin path to the DLL search path then creates a new JVM instance. This triggers the lazy loading of jvm.dll.
+void REDappWrapperPrivate::_init() {
+	if (m_pool)
+		delete m_pool;
+
+	//IDs and global references from the old JVM are meaningless in the new one
+	m_classCache.invalidate();
+	m_methodCache.invalidate();
+	m_staticMethodCache.invalidate();
+	m_fieldCache.invalidate();
+	m_staticFieldCache.invalidate();
+	std::fill(std::begin(m_classes), std::end(m_classes), nullptr);
+	std::fill(std::begin(m_members), std::end(m_members), resolved_member{});
+
+	if (!m_jvm)
+		m_jvm = NativeJVM::construct();
+
+	//every worker needs its own JNIEnv, the primary worker gets one when it creates the JVM
+	m_pool = new WorkerPool(m_workerCount);
+	auto attach = [this] { m_jvm->AttachCurrentThread(); };
+	auto detach = [this] { m_jvm->DetachCurrentThread(); };
+	m_pool->add(attach, detach);
+	//the JVM is always created by the primary worker, even when calls are made directly
+	WorkerThread::job_t job = [this] {
+		m_jvm->Initialize(m_overridePath);
+		if (m_jvm->IsValid())
+			resolveRegistry();
+	};
+	m_pool->primary()->runJob(job);
+
 	if (m_jvm->IsValid()) {
-		jint retval = 0;
-		WorkerThread::job_t job = [&retval,obj,fid,this]{
-			retval = m_jvm->GetIntField(obj, fid);
-		};
-		run(job);
-		return retval;
+		while (m_pool->add(attach, detach));
 	}
-	return JNI_ERR;
 }
 
-jdouble REDappWrapperPrivate::CallDoubleField(jobject obj, jfieldID fid) {
-	init();
-	if (m_jvm->IsValid()) {
-		jdouble retval;
-		WorkerThread::job_t job = [&retval,obj,fid,this]{
-			retval = m_jvm->GetDoubleField(obj, fid);
-		};
-		run(job);
-		return retval;
+REDappWrapperPrivate::~REDappWrapperPrivate() {
+	//resumed coroutines may still call into Java so they finish before the workers go
+	m_resumer.reset();
+	if (m_pool)
+	{
+		delete m_pool;
+		m_pool = nullptr;
 	}
-	return JNI_ERR;
+	m_jvm = nullptr;
 }
 
-jlong REDappWrapperPrivate::CallLongField(jobject obj, jfieldID fid) {
-	init();
-	if (m_jvm->IsValid()) {
-		jlong retval;
-		WorkerThread::job_t job = [&retval,obj,fid,this]{
-			retval = m_jvm->GetLongField(obj, fid);
-		};
-		run(job);
-		return retval;
-	}
-	return JNI_ERR;
+/**
+ * Look up the Java constant matching a native enum value. The constants are global references
+ * owned by the registry, callers must not delete them. Values outside of the table fall back to
+ * the given default.
+ */
+template<typename _Enum, size_t _Count>
+static jobject EnumToJava(const JavaRegistry::Member (&table)[_Count], _Enum value, _Enum fallback) {
+	REDappWrapperPrivate& priv = REDappWrapperPrivate::get_mutable_instance();
+	size_t index = (size_t)value;
+	if (index >= _Count)
+		index = (size_t)fallback;
+	return priv.Constant(table[index]);
+}
+
+static_assert(std::size(JavaRegistry::ModelConstants) == (size_t)REDapp::Model::CUSTOM + 1);
+static_assert(std::size(JavaRegistry::SpotWXModelConstants) == (size_t)REDapp::SpotWXModel::GEPS + 1);
+static_assert(std::size(JavaRegistry::TimeConstants) == (size_t)REDapp::Time::NOON + 1);
+static_assert(std::size(JavaRegistry::ProvinceConstants) == (size_t)REDapp::Province::YUKON + 1);
+
+static jobject ModelToJava(REDapp::Model mod) {
+	return EnumToJava(JavaRegistry::ModelConstants, mod, REDapp::Model::CUSTOM);
+}
+
+static jobject TimeToJava(REDapp::Time tim) {
+	return EnumToJava(JavaRegistry::TimeConstants, tim, REDapp::Time::NOON);
+}
+
+static jobject ProvinceToJava(REDapp::Province prov) {
+	return EnumToJava(JavaRegistry::ProvinceConstants, prov, REDapp::Province::MANITOBA);
 }
 
-jboolean REDappWrapperPrivate::ExceptionCheck() {
+void REDappWrapperPrivate::DeleteObject(jobject obj) {
 	init();
-	if (m_jvm->IsValid()) {
-		jboolean exc;
-		WorkerThread::job_t job = [&exc,this]{
-			exc = m_jvm->ExceptionCheck();
+	if (m_jvm->IsValid())
+	{
+		WorkerThread::job_t job = [obj, this] {
+			if (m_jvm->GetObjectRefType(obj) == JNIGlobalRefType)
+				m_jvm->DeleteGlobalRef(obj);
+			else
+				m_jvm->DeleteLocalRef(obj);
 		};
 		run(job);
-		return exc;
 	}
-	return false;
 }
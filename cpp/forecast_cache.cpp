@@ -0,0 +1,271 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: forecast_cache.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "forecast_cache.h"
+#include "filesystem.hpp"
+
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+
+
+/**
+ * Identifies a cache file and the version of its layout.
+ */
+static constexpr char CacheMagic[8] = { 'R', 'E', 'D', 'F', 'C', 'S', 'T', '1' };
+static constexpr const char* CacheExtension = ".fcst";
+
+/**
+ * One hour as it is stored in a cache file.
+ */
+struct CachedHour {
+	std::int64_t time;
+	double temperature;
+	double rh;
+	double precipitation;
+	double windSpeed;
+	double windDirection;
+	std::uint32_t specifiedBits;
+};
+
+/**
+ * A stable 64 bit FNV-1a hash, std::hash isn't guaranteed to be the same between runs.
+ */
+static std::uint64_t HashKey(const std::string& key) {
+	std::uint64_t hash = 0xcbf29ce484222325ULL;
+	for (unsigned char c : key) {
+		hash ^= c;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+void ForecastCache::configure(const REDapp::ForecastCacheOptions& options) {
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_options = options;
+	m_enabled.store(options.ttl.count() > 0, std::memory_order_relaxed);
+	if (!m_options.directory.empty()) {
+		std::error_code ec;
+		fs::create_directories(fs::path(m_options.directory), ec);
+	}
+	while (m_entries.size() > m_options.capacity) {
+		m_index.erase(m_entries.back().key);
+		m_entries.pop_back();
+		m_evictions.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+REDapp::ForecastCacheOptions ForecastCache::options() {
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_options;
+}
+
+bool ForecastCache::expired(clock::time_point created, clock::time_point now) const {
+	return now - created >= m_options.ttl || created > now;
+}
+
+std::shared_ptr<const ForecastHours> ForecastCache::find(const std::string& key) {
+	clock::time_point now = clock::now();
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		auto it = m_index.find(key);
+		if (it != m_index.end()) {
+			if (!expired(it->second->created, now)) {
+				m_entries.splice(m_entries.begin(), m_entries, it->second);
+				m_memoryHits.fetch_add(1, std::memory_order_relaxed);
+				return it->second->hours;
+			}
+			m_entries.erase(it->second);
+			m_index.erase(it);
+		}
+	}
+
+	//the file is read outside the lock so a slow disk doesn't hold up memory hits
+	clock::time_point created;
+	std::shared_ptr<const ForecastHours> hours = read(key, created);
+	if (hours) {
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (!expired(created, now)) {
+			insertLocked(entry{ key, created, hours });
+			m_diskHits.fetch_add(1, std::memory_order_relaxed);
+			return hours;
+		}
+	}
+	m_misses.fetch_add(1, std::memory_order_relaxed);
+	return nullptr;
+}
+
+void ForecastCache::insert(const std::string& key, std::shared_ptr<const ForecastHours> hours) {
+	clock::time_point created = clock::now();
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		insertLocked(entry{ key, created, hours });
+	}
+	write(key, created, *hours);
+}
+
+void ForecastCache::insertLocked(entry&& e) {
+	auto it = m_index.find(e.key);
+	if (it != m_index.end()) {
+		m_entries.erase(it->second);
+		m_index.erase(it);
+	}
+	if (m_options.capacity == 0)
+		return;
+	m_entries.push_front(std::move(e));
+	m_index[m_entries.front().key] = m_entries.begin();
+	while (m_entries.size() > m_options.capacity) {
+		m_index.erase(m_entries.back().key);
+		m_entries.pop_back();
+		m_evictions.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void ForecastCache::clear() {
+	std::string directory;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_entries.clear();
+		m_index.clear();
+		directory = m_options.directory;
+	}
+	if (directory.empty())
+		return;
+
+	//only remove files this cache wrote, the directory may be shared
+	std::error_code ec;
+	std::vector<fs::path> files;
+	for (fs::directory_iterator it(fs::path(directory), ec), end; !ec && it != end; it.increment(ec)) {
+		if (it->path().extension() == CacheExtension)
+			files.push_back(it->path());
+	}
+	for (const fs::path& file : files)
+		fs::remove(file, ec);
+}
+
+REDapp::ForecastCacheStatistics ForecastCache::statistics() {
+	REDapp::ForecastCacheStatistics stats{};
+	stats.memoryHits = m_memoryHits.load(std::memory_order_relaxed);
+	stats.diskHits = m_diskHits.load(std::memory_order_relaxed);
+	stats.misses = m_misses.load(std::memory_order_relaxed);
+	stats.evictions = m_evictions.load(std::memory_order_relaxed);
+	return stats;
+}
+
+std::string ForecastCache::filename(const std::string& key) const {
+	if (m_options.directory.empty())
+		return std::string();
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long)HashKey(key));
+	return (fs::path(m_options.directory) / (std::string(name) + CacheExtension)).string();
+}
+
+/**
+ * The layout is the magic, the creation time in milliseconds since the epoch, the key so hash
+ * collisions can be detected, then the hours. Values are in the native byte order, the files are
+ * only meant to be read back on the machine that wrote them.
+ */
+std::shared_ptr<const ForecastHours> ForecastCache::read(const std::string& key, clock::time_point& created) {
+	std::string file;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		file = filename(key);
+	}
+	if (file.empty())
+		return nullptr;
+	std::ifstream in(file, std::ios::binary);
+	if (!in)
+		return nullptr;
+
+	char magic[sizeof(CacheMagic)];
+	std::int64_t millis;
+	std::uint32_t keyLength;
+	if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, CacheMagic, sizeof(magic)) ||
+			!in.read(reinterpret_cast<char*>(&millis), sizeof(millis)) ||
+			!in.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength)) || keyLength != key.size())
+		return nullptr;
+	std::string stored(keyLength, '\0');
+	std::uint32_t count;
+	if (!in.read(stored.data(), keyLength) || stored != key ||
+			!in.read(reinterpret_cast<char*>(&count), sizeof(count)))
+		return nullptr;
+
+	std::vector<CachedHour> cached(count);
+	if (count && !in.read(reinterpret_cast<char*>(cached.data()), count * sizeof(CachedHour)))
+		return nullptr;
+
+	auto hours = std::make_shared<ForecastHours>();
+	hours->hours.resize(count);
+	hours->times.resize(count);
+	for (std::uint32_t i = 0; i < count; i++) {
+		hours->times[i] = cached[i].time;
+		IWXData& data = hours->hours[i];
+		data.Temperature = cached[i].temperature;
+		data.RH = cached[i].rh;
+		data.Precipitation = cached[i].precipitation;
+		data.WindSpeed = cached[i].windSpeed;
+		data.WindDirection = cached[i].windDirection;
+		data.SpecifiedBits = cached[i].specifiedBits;
+	}
+	created = clock::time_point(std::chrono::duration_cast<clock::duration>(std::chrono::milliseconds(millis)));
+	return hours;
+}
+
+void ForecastCache::write(const std::string& key, clock::time_point created, const ForecastHours& hours) {
+	std::string file;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		file = filename(key);
+	}
+	if (file.empty())
+		return;
+
+	std::vector<CachedHour> cached(hours.hours.size());
+	for (size_t i = 0; i < cached.size(); i++) {
+		const IWXData& data = hours.hours[i];
+		cached[i] = CachedHour{ hours.times[i], data.Temperature, data.RH, data.Precipitation, data.WindSpeed, data.WindDirection, (std::uint32_t)data.SpecifiedBits };
+	}
+	std::int64_t millis = std::chrono::duration_cast<std::chrono::milliseconds>(created.time_since_epoch()).count();
+	std::uint32_t keyLength = (std::uint32_t)key.size();
+	std::uint32_t count = (std::uint32_t)cached.size();
+
+	//write beside the real file and rename it into place so readers never see half a file
+	std::string temp = file + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	{
+		std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+		if (!out)
+			return;
+		out.write(CacheMagic, sizeof(CacheMagic));
+		out.write(reinterpret_cast<const char*>(&millis), sizeof(millis));
+		out.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+		out.write(key.data(), keyLength);
+		out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		out.write(reinterpret_cast<const char*>(cached.data()), cached.size() * sizeof(CachedHour));
+		if (!out) {
+			out.close();
+			std::error_code ec;
+			fs::remove(fs::path(temp), ec);
+			return;
+		}
+	}
+	std::error_code ec;
+	fs::rename(fs::path(temp), fs::path(file), ec);
+	if (ec)
+		fs::remove(fs::path(temp), ec);
+}
@@ -0,0 +1,256 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: hourly_parser.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hourly_parser.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+
+
+namespace {
+	enum class Column {
+		DATE,
+		HOUR,
+		TEMP,
+		RH,
+		WD,
+		WS,
+		WG,
+		PRECIP,
+		COUNT
+	};
+
+	constexpr std::size_t ColumnCount = (std::size_t)Column::COUNT;
+	constexpr std::size_t MaxFields = 16;
+
+	/**
+	 * A cursor over the lines of a file.
+	 */
+	class LineReader {
+	public:
+		LineReader(const char* data, std::size_t size) : m_pos(data), m_end(data + size) { }
+
+		/**
+		 * Get the next line without its line ending. Returns false at the end of the data.
+		 */
+		bool next(std::string_view& line) {
+			if (m_pos >= m_end)
+				return false;
+			//memchr is vectorized by every C library we build against
+			const char* eol = static_cast<const char*>(std::memchr(m_pos, '\n', (std::size_t)(m_end - m_pos)));
+			if (!eol)
+				eol = m_end;
+			const char* last = eol;
+			if (last > m_pos && last[-1] == '\r')
+				last--;
+			line = std::string_view(m_pos, (std::size_t)(last - m_pos));
+			m_pos = eol + 1;
+			return true;
+		}
+
+	private:
+		const char* m_pos;
+		const char* m_end;
+	};
+
+	std::string_view trim(std::string_view str) {
+		while (!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+			str.remove_prefix(1);
+		while (!str.empty() && (str.back() == ' ' || str.back() == '\t'))
+			str.remove_suffix(1);
+		return str;
+	}
+
+	/**
+	 * Split a line on commas. Returns the number of fields, or MaxFields + 1 if there are too many.
+	 */
+	std::size_t split(std::string_view line, std::string_view (&fields)[MaxFields]) {
+		std::size_t count = 0;
+		while (true) {
+			if (count == MaxFields)
+				return MaxFields + 1;
+			std::size_t comma = line.find(',');
+			fields[count++] = trim(line.substr(0, comma));
+			if (comma == std::string_view::npos)
+				break;
+			line.remove_prefix(comma + 1);
+		}
+		return count;
+	}
+
+	bool iequals(std::string_view a, std::string_view b) {
+		return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char l, char r) {
+			return (l >= 'a' && l <= 'z' ? l - 'a' + 'A' : l) == r;
+		});
+	}
+
+	/**
+	 * Find the column a header name refers to. Returns COUNT for unknown names.
+	 */
+	Column headerColumn(std::string_view name) {
+		if (iequals(name, "HOURLY") || iequals(name, "DATE"))
+			return Column::DATE;
+		if (iequals(name, "HOUR"))
+			return Column::HOUR;
+		if (iequals(name, "TEMP"))
+			return Column::TEMP;
+		if (iequals(name, "RH"))
+			return Column::RH;
+		if (iequals(name, "WD"))
+			return Column::WD;
+		if (iequals(name, "WS"))
+			return Column::WS;
+		if (iequals(name, "WG") || iequals(name, "GUST"))
+			return Column::WG;
+		if (iequals(name, "PRECIP") || iequals(name, "RAIN"))
+			return Column::PRECIP;
+		return Column::COUNT;
+	}
+
+	template<typename T>
+	bool parseNumber(std::string_view str, T& value) {
+		if (str.empty())
+			return false;
+		if (str.front() == '+')
+			str.remove_prefix(1);
+		auto result = std::from_chars(str.data(), str.data() + str.size(), value);
+		return result.ec == std::errc() && result.ptr == str.data() + str.size();
+	}
+
+	bool parseDouble(std::string_view str, double& value) {
+		return parseNumber(str, value) && std::isfinite(value);
+	}
+
+	/**
+	 * Parse a yyyy-mm-dd date into seconds since the Unix epoch.
+	 */
+	bool parseDate(std::string_view str, std::int64_t& seconds) {
+		if (str.size() != 10 || str[4] != '-' || str[7] != '-')
+			return false;
+		int y, m, d;
+		if (!parseNumber(str.substr(0, 4), y) || !parseNumber(str.substr(5, 2), m) || !parseNumber(str.substr(8, 2), d))
+			return false;
+		std::chrono::year_month_day date{ std::chrono::year(y), std::chrono::month((unsigned)m), std::chrono::day((unsigned)d) };
+		if (!date.ok())
+			return false;
+		seconds = (std::int64_t)std::chrono::sys_days(date).time_since_epoch().count() * 86400;
+		return true;
+	}
+}
+
+static bool parseHours(const char* data, std::size_t size, const HourlyParser::Settings& settings, WeatherSeries& out) {
+	if (settings.daylightSavings != 0)
+		return false;
+
+	if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+		data += 3;
+		size -= 3;
+	}
+
+	LineReader reader(data, size);
+	std::string_view line;
+	std::string_view fields[MaxFields];
+	if (!reader.next(line))
+		return false;
+	std::size_t fieldCount = split(line, fields);
+	if (fieldCount > MaxFields)
+		return false;
+
+	std::size_t columns[ColumnCount];
+	std::fill(std::begin(columns), std::end(columns), MaxFields);
+	for (std::size_t i = 0; i < fieldCount; i++) {
+		Column c = headerColumn(fields[i]);
+		if (c == Column::COUNT || columns[(std::size_t)c] != MaxFields)
+			return false;
+		columns[(std::size_t)c] = i;
+	}
+	for (std::size_t c = 0; c < ColumnCount; c++) {
+		if (columns[c] == MaxFields && (Column)c != Column::WG)
+			return false;
+	}
+	const bool hasGust = columns[(std::size_t)Column::WG] != MaxFields;
+
+	//every line after the header is at most one hour
+	out.resize((std::size_t)std::count(data, data + size, '\n') + 1);
+	std::size_t row = 0;
+	std::int64_t previous = 0;
+	while (reader.next(line)) {
+		if (trim(line).empty())
+			continue;
+		if (split(line, fields) != fieldCount)
+			return false;
+
+		std::int64_t day;
+		int hour;
+		double temp, rh, wd, ws, wg = -1.0, precip;
+		if (!parseDate(fields[columns[(std::size_t)Column::DATE]], day) ||
+				!parseNumber(fields[columns[(std::size_t)Column::HOUR]], hour) ||
+				!parseDouble(fields[columns[(std::size_t)Column::TEMP]], temp) ||
+				!parseDouble(fields[columns[(std::size_t)Column::RH]], rh) ||
+				!parseDouble(fields[columns[(std::size_t)Column::WD]], wd) ||
+				!parseDouble(fields[columns[(std::size_t)Column::WS]], ws) ||
+				!parseDouble(fields[columns[(std::size_t)Column::PRECIP]], precip) ||
+				(hasGust && !parseDouble(fields[columns[(std::size_t)Column::WG]], wg)))
+			return false;
+		//out of range values are left for Java to handle according to the stream settings
+		if (hour < 0 || hour > 23 || rh < 0.0 || rh > 100.0 || wd < 0.0 || wd > 360.0 ||
+				ws < 0.0 || precip < 0.0 || (hasGust && wg < 0.0))
+			return false;
+
+		std::int64_t epoch = day + hour * 3600 - settings.timezone;
+		//gaps and repeated hours are also left for Java
+		if (row > 0 && epoch != previous + 3600)
+			return false;
+		previous = epoch;
+
+		out.hour[row] = hour;
+		out.epoch[row] = (uint_fast64_t)epoch;
+		out.temp[row] = temp;
+		out.rh[row] = rh;
+		out.wd[row] = wd;
+		out.ws[row] = ws;
+		out.wg[row] = wg;
+		out.precip[row] = precip;
+		row++;
+	}
+
+	if (row == 0)
+		return false;
+	out.resize(row);
+	return true;
+}
+
+bool HourlyParser::parse(const char* data, std::size_t size, const Settings& settings, WeatherSeries& out) {
+	out.clear();
+	if (parseHours(data, size, settings, out))
+		return true;
+	out.clear();
+	return false;
+}
+
+bool HourlyParser::parseFile(const std::string& filename, const Settings& settings, WeatherSeries& out) {
+	std::unique_ptr<MappedFile> file = MappedFile::open(filename);
+	if (!file)
+		return false;
+	return parse(file->data(), file->size(), settings, out);
+}
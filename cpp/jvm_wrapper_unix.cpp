@@ -52,17 +52,23 @@ static std::vector<std::string> dependencies =
   "SparseBitSet.jar", "weather.jar", "wtime.jar",
   "xmlbeans.jar" };
 
+/**
+ * Jars added to the class path only if they're installed. The wrapper's own adapter lets it copy
+ * data out of Java in bulk, without it the wrapper falls back to reading field by field.
+ */
+static std::vector<std::string> optionalDependencies =
+{ "REDappWrapperAdapter.jar" };
+
 
 class NativeJVM_Unix : public NativeJVM {
 public:
     void* m_handle;
 	JavaVM *m_jvm;
-	JNIEnv* m_env;
 	bool m_valid;
 	bool m_init;
 	unsigned long error_code;
 
-	NativeJVM_Unix() : m_jvm(nullptr), m_env(nullptr), m_valid(false), m_init(false), m_handle(nullptr) { }
+	NativeJVM_Unix() : m_jvm(nullptr), m_valid(false), m_init(false), m_handle(nullptr) { }
 	virtual ~NativeJVM_Unix();
 
 	virtual bool Initialize(const std::string& overridePath) override;
@@ -71,20 +77,27 @@ public:
 	virtual bool IsValid() override { return m_valid; }
 	virtual unsigned long GetLoadError() override { return error_code; }
 
-	jclass FindClass(const std::string& signature) override;
-	jfieldID GetStaticFieldID(jclass clz, const std::string& name, const std::string& signature) override;
+	bool AttachCurrentThread() override;
+	bool AttachCurrentThreadAsDaemon() override;
+	void DetachCurrentThread() override;
+
+	jclass FindClass(const char* signature) override;
+	jfieldID GetStaticFieldID(jclass clz, const char* name, const char* signature) override;
 	jobject GetStaticObjectField(jclass clz, jfieldID fld) override;
-	jmethodID GetMethodID(jclass clz, const std::string& name, const std::string& signature) override;
-	jmethodID GetStaticMethodID(jclass clz, const std::string& name, const std::string& signature) override;
-	jfieldID GetFieldID(jclass clz, const std::string& name, const std::string& signature) override;
+	jmethodID GetMethodID(jclass clz, const char* name, const char* signature) override;
+	jmethodID GetStaticMethodID(jclass clz, const char* name, const char* signature) override;
+	jfieldID GetFieldID(jclass clz, const char* name, const char* signature) override;
 
 	jobject CallStaticObjectMethod(jclass cls, jmethodID mid, jobject param) override;
+	jobject CallStaticObjectMethodOOO(jclass cls, jmethodID mid, jobject o1, jobject o2, jobject o3) override;
 	jobject CallStaticObjectMethod(jclass cls, jmethodID mid, jint param) override;
 	jboolean CallStaticBooleanMethod(jclass cls, jmethodID mid, jobject param) override;
+	jboolean CallStaticBooleanMethodOOOO(jclass cls, jmethodID mid, jobject o1, jobject o2, jobject o3, jobject o4) override;
 	jobject CallObjectMethodO(jobject obj, jmethodID mid, jobject o) override;
 	jobject CallObjectMethodOO(jobject obj, jmethodID mid, jobject o1, jobject o2) override;
 	jobject CallObjectMethodOOI(jobject obj, jmethodID mid, jobject o1, jobject o2, jint i1) override;
 	jobject CallObjectMethod(jobject obj, jmethodID mid, jint ind) override;
+	jobject CallObjectMethodII(jobject obj, jmethodID mid, jint i1, jint i2) override;
 	jdouble CallDoubleMethod(jobject obj, jmethodID mid, ...) override;
 	jobject CallObjectDoubleMethod(jobject obj, jmethodID mid, ...) override;
 	jboolean CallBooleanMethod(jobject obj, jmethodID mid) override;
@@ -104,10 +117,18 @@ public:
 	jstring NewStringUTF(const char* str) override;
 	void DeleteLocalRef(jstring str) override;
 	void DeleteLocalRef(jobject str) override;
+	jobject NewGlobalRef(jobject obj) override;
+	void DeleteGlobalRef(jobject obj) override;
+	jobjectRefType GetObjectRefType(jobject obj) override;
 	jobject NewObject(jclass cls, jmethodID constructor, jobject param) override;
 	jobject NewObject(jclass cls, jmethodID constructor, jlong param) override;
 	jintArray NewIntArray(int size) override;
 	jdoubleArray NewDoubleArray(int size) override;
+	jlongArray NewLongArray(int size) override;
+	void GetIntArrayRegion(jintArray arr, int start, int length, jint* buffer) override;
+	void GetDoubleArrayRegion(jdoubleArray arr, int start, int length, jdouble* buffer) override;
+	void GetLongArrayRegion(jlongArray arr, int start, int length, jlong* buffer) override;
+	void SetDoubleArrayRegion(jdoubleArray arr, int start, int length, const jdouble* buffer) override;
 	jobjectArray NewObjectArray(int size, jclass cls) override;
 	void SetIntField(jobject obj, jfieldID fld, jint val) override;
 	void SetDoubleField(jobject obj, jfieldID fld, jdouble val) override;
@@ -119,8 +140,31 @@ public:
 	jdouble GetDoubleField(jobject obj, jfieldID fid) override;
 	jlong GetLongField(jobject obj, jfieldID fid) override;
 	jboolean ExceptionCheck() override;
+	void ExceptionClear() override;
 };
 
+/**
+ * The JNIEnv for the calling thread. Only valid on threads that created or have been attached to the JVM.
+ */
+static thread_local JNIEnv* t_env = nullptr;
+
+static inline JNIEnv* env() { return t_env; }
+
+/**
+ * Detaches threads that attached themselves as daemons when they exit.
+ */
+struct daemon_detach {
+	JavaVM* jvm = nullptr;
+
+	~daemon_detach() {
+		if (jvm && t_env)
+			jvm->DetachCurrentThread();
+		t_env = nullptr;
+	}
+};
+
+static thread_local daemon_detach t_detach;
+
 std::unique_ptr<NativeJVM> NativeJVM::construct() {
 	return std::unique_ptr<NativeJVM>{ new NativeJVM_Unix() };
 }
@@ -265,6 +309,13 @@ bool NativeJVM_Unix::Initialize(const std::string& overridePath) {
                         key += p.string();
                         key += ":";
                     }
+                    for (auto& dep : optionalDependencies) {
+                        p = p.replace_filename(dep);
+                        if (fs::exists(p)) {
+                            key += p.string();
+                            key += ":";
+                        }
+                    }
                     options[0].optionString = const_cast<char*>(key.c_str());
 #ifdef _DEBUG
                     options[1].optionString = const_cast<char*>("-verbose:jni");
@@ -286,7 +337,7 @@ bool NativeJVM_Unix::Initialize(const std::string& overridePath) {
                     }
                     delete[] options;
                     if (jvmError == JNI_OK && jvm && env) {
-                        m_env = env;
+                        t_env = env;
                         m_jvm = jvm;
                         m_valid = internalError != ERROR_MISSING_JAR;
                         javaPath = jvmLocation.value().parent_path().parent_path().parent_path().string();
@@ -330,7 +381,7 @@ bool NativeJVM_Unix::Initialize(const std::string& overridePath) {
 }
 
 void NativeJVM_Unix::InitializeVersion() {
-	jint ver = m_env->GetVersion();
+	jint ver = env()->GetVersion();
 	jint major = (ver >> 16) & 0xFFFF;
 	jint minor = ver & 0xFFFF;
 	javaVersion = std::to_string(major) + "." + std::to_string(minor);
@@ -338,7 +389,6 @@ void NativeJVM_Unix::InitializeVersion() {
 
 NativeJVM_Unix::~NativeJVM_Unix() {
 	m_jvm = nullptr;
-	m_env = nullptr;
     if (m_handle)
     {
         dlclose(m_handle);
@@ -346,63 +396,108 @@ NativeJVM_Unix::~NativeJVM_Unix() {
     }
 }
 
-jclass NativeJVM_Unix::FindClass(const std::string& signature) {
-	return m_env->FindClass(signature.c_str());
+bool NativeJVM_Unix::AttachCurrentThread() {
+	if (t_env)
+		return true;
+	if (!m_jvm)
+		return false;
+	JNIEnv* e;
+	if (m_jvm->AttachCurrentThread((void**)&e, nullptr) != JNI_OK)
+		return false;
+	t_env = e;
+	return true;
+}
+
+bool NativeJVM_Unix::AttachCurrentThreadAsDaemon() {
+	if (t_env)
+		return true;
+	if (!m_jvm)
+		return false;
+	JNIEnv* e;
+	if (m_jvm->AttachCurrentThreadAsDaemon((void**)&e, nullptr) != JNI_OK)
+		return false;
+	t_env = e;
+	t_detach.jvm = m_jvm;
+	return true;
+}
+
+void NativeJVM_Unix::DetachCurrentThread() {
+	if (t_env && m_jvm) {
+		m_jvm->DetachCurrentThread();
+		t_env = nullptr;
+		t_detach.jvm = nullptr;
+	}
+}
+
+jclass NativeJVM_Unix::FindClass(const char* signature) {
+	return env()->FindClass(signature);
 }
 
-jfieldID NativeJVM_Unix::GetStaticFieldID(jclass clz, const std::string& name, const std::string& signature) {
-	return m_env->GetStaticFieldID(clz, name.c_str(), signature.c_str());
+jfieldID NativeJVM_Unix::GetStaticFieldID(jclass clz, const char* name, const char* signature) {
+	return env()->GetStaticFieldID(clz, name, signature);
 }
 
 jobject NativeJVM_Unix::GetStaticObjectField(jclass clz, jfieldID fld) {
-	return m_env->GetStaticObjectField(clz, fld);
+	return env()->GetStaticObjectField(clz, fld);
 }
 
-jmethodID NativeJVM_Unix::GetMethodID(jclass clz, const std::string& name, const std::string& signature) {
-	return m_env->GetMethodID(clz, name.c_str(), signature.c_str());
+jmethodID NativeJVM_Unix::GetMethodID(jclass clz, const char* name, const char* signature) {
+	return env()->GetMethodID(clz, name, signature);
 }
 
-jmethodID NativeJVM_Unix::GetStaticMethodID(jclass clz, const std::string& name, const std::string& signature) {
-	return m_env->GetStaticMethodID(clz, name.c_str(), signature.c_str());
+jmethodID NativeJVM_Unix::GetStaticMethodID(jclass clz, const char* name, const char* signature) {
+	return env()->GetStaticMethodID(clz, name, signature);
 }
 
-jfieldID NativeJVM_Unix::GetFieldID(jclass clz, const std::string& name, const std::string& signature) {
-	return m_env->GetFieldID(clz, name.c_str(), signature.c_str());
+jfieldID NativeJVM_Unix::GetFieldID(jclass clz, const char* name, const char* signature) {
+	return env()->GetFieldID(clz, name, signature);
 }
 
 
 jobject NativeJVM_Unix::CallStaticObjectMethod(jclass cls, jmethodID mid, jobject param) {
-	return m_env->CallStaticObjectMethod(cls, mid, param);
+	return env()->CallStaticObjectMethod(cls, mid, param);
+}
+
+jobject NativeJVM_Unix::CallStaticObjectMethodOOO(jclass cls, jmethodID mid, jobject o1, jobject o2, jobject o3) {
+	return env()->CallStaticObjectMethod(cls, mid, o1, o2, o3);
 }
 
 jobject NativeJVM_Unix::CallStaticObjectMethod(jclass cls, jmethodID mid, jint param) {
-	return m_env->CallStaticObjectMethod(cls, mid, param);
+	return env()->CallStaticObjectMethod(cls, mid, param);
 }
 
 jboolean NativeJVM_Unix::CallStaticBooleanMethod(jclass cls, jmethodID mid, jobject param) {
-	return m_env->CallStaticBooleanMethod(cls, mid, param);
+	return env()->CallStaticBooleanMethod(cls, mid, param);
+}
+
+jboolean NativeJVM_Unix::CallStaticBooleanMethodOOOO(jclass cls, jmethodID mid, jobject o1, jobject o2, jobject o3, jobject o4) {
+	return env()->CallStaticBooleanMethod(cls, mid, o1, o2, o3, o4);
 }
 
 jobject NativeJVM_Unix::CallObjectMethodO(jobject obj, jmethodID mid, jobject o) {
-	return m_env->CallObjectMethod(obj, mid, o);
+	return env()->CallObjectMethod(obj, mid, o);
 }
 
 jobject NativeJVM_Unix::CallObjectMethodOO(jobject obj, jmethodID mid, jobject o1, jobject o2) {
-	return m_env->CallObjectMethod(obj, mid, o1, o2);
+	return env()->CallObjectMethod(obj, mid, o1, o2);
 }
 
 jobject NativeJVM_Unix::CallObjectMethodOOI(jobject obj, jmethodID mid, jobject o1, jobject o2, jint i1) {
-	return m_env->CallObjectMethod(obj, mid, o1, o2, i1);
+	return env()->CallObjectMethod(obj, mid, o1, o2, i1);
 }
 
 jobject NativeJVM_Unix::CallObjectMethod(jobject obj, jmethodID mid, jint ind) {
-	return m_env->CallObjectMethod(obj, mid, ind);
+	return env()->CallObjectMethod(obj, mid, ind);
+}
+
+jobject NativeJVM_Unix::CallObjectMethodII(jobject obj, jmethodID mid, jint i1, jint i2) {
+	return env()->CallObjectMethod(obj, mid, i1, i2);
 }
 
 jdouble NativeJVM_Unix::CallDoubleMethod(jobject obj, jmethodID mid, ...) {
 	va_list vl;
 	va_start(vl, mid);
-	jdouble jd = m_env->CallDoubleMethod(obj, mid, vl);
+	jdouble jd = env()->CallDoubleMethod(obj, mid, vl);
 	va_end(vl);
 	return jd;
 }
@@ -410,135 +505,171 @@ jdouble NativeJVM_Unix::CallDoubleMethod(jobject obj, jmethodID mid, ...) {
 jobject NativeJVM_Unix::CallObjectDoubleMethod(jobject obj, jmethodID mid, ...) {
 	va_list vl;
 	va_start(vl, mid);
-	jobject jo = m_env->CallObjectMethod(obj, mid, vl);
+	jobject jo = env()->CallObjectMethod(obj, mid, vl);
 	va_end(vl);
 	return jo;
 }
 
 jboolean NativeJVM_Unix::CallBooleanMethod(jobject obj, jmethodID mid) {
-	return m_env->CallBooleanMethod(obj, mid);
+	return env()->CallBooleanMethod(obj, mid);
 }
 
 jboolean NativeJVM_Unix::CallBooleanMethod(jobject obj, jmethodID mid, int param) {
-	return m_env->CallBooleanMethod(obj, mid, param);
+	return env()->CallBooleanMethod(obj, mid, param);
 }
 
 jint NativeJVM_Unix::CallIntMethod(jobject obj, jmethodID mid) {
-	return m_env->CallIntMethod(obj, mid);
+	return env()->CallIntMethod(obj, mid);
 }
 
 jint NativeJVM_Unix::CallIntMethod(jobject obj, jmethodID mid, jint param) {
-	return m_env->CallIntMethod(obj, mid, param);
+	return env()->CallIntMethod(obj, mid, param);
 }
 
 jlong NativeJVM_Unix::CallLongMethod(jobject obj, jmethodID mid) {
-	return m_env->CallLongMethod(obj, mid);
+	return env()->CallLongMethod(obj, mid);
 }
 
 void NativeJVM_Unix::CallMethod(jobject obj, jmethodID mid, jobject param) {
-	return m_env->CallVoidMethod(obj, mid, param);
+	return env()->CallVoidMethod(obj, mid, param);
 }
 
 void NativeJVM_Unix::CallMethod(jobject obj, jmethodID mid, jint param) {
-	return m_env->CallVoidMethod(obj, mid, param);
+	return env()->CallVoidMethod(obj, mid, param);
 }
 
 void NativeJVM_Unix::CallMethod(jobject obj, jmethodID mid, jint param1, jint param2) {
-	return m_env->CallVoidMethod(obj, mid, param1, param2);
+	return env()->CallVoidMethod(obj, mid, param1, param2);
 }
 
 void NativeJVM_Unix::CallMethod(jobject obj, jmethodID mid, jdouble param) {
-	return m_env->CallVoidMethod(obj, mid, param);
+	return env()->CallVoidMethod(obj, mid, param);
 }
 
 void NativeJVM_Unix::CallMethod(jobject obj, jmethodID mid, jlong param) {
-	return m_env->CallVoidMethod(obj, mid, param);
+	return env()->CallVoidMethod(obj, mid, param);
 }
 
 int NativeJVM_Unix::GetArrayLength(jarray arr) {
-	return m_env->GetArrayLength(arr);
+	return env()->GetArrayLength(arr);
 }
 
 jobject NativeJVM_Unix::GetObjectArrayElement(jobjectArray arr, int index) {
-	return m_env->GetObjectArrayElement(arr, index);
+	return env()->GetObjectArrayElement(arr, index);
 }
 
 const char* NativeJVM_Unix::GetStringUTFChars(jstring str) {
-	return m_env->GetStringUTFChars(str, nullptr);
+	return env()->GetStringUTFChars(str, nullptr);
 }
 
 void NativeJVM_Unix::ReleaseStringUTFChars(jstring str, const char* s) {
-	return m_env->ReleaseStringUTFChars(str, s);
+	return env()->ReleaseStringUTFChars(str, s);
 }
 
 jstring NativeJVM_Unix::NewStringUTF(const char* str) {
-	return m_env->NewStringUTF(str);
+	return env()->NewStringUTF(str);
 }
 
 void NativeJVM_Unix::DeleteLocalRef(jstring str) {
-	return m_env->DeleteLocalRef(str);
+	return env()->DeleteLocalRef(str);
 }
 
 void NativeJVM_Unix::DeleteLocalRef(jobject str) {
-	return m_env->DeleteLocalRef(str);
+	return env()->DeleteLocalRef(str);
+}
+
+jobject NativeJVM_Unix::NewGlobalRef(jobject obj) {
+	return env()->NewGlobalRef(obj);
+}
+
+void NativeJVM_Unix::DeleteGlobalRef(jobject obj) {
+	return env()->DeleteGlobalRef(obj);
+}
+
+jobjectRefType NativeJVM_Unix::GetObjectRefType(jobject obj) {
+	return env()->GetObjectRefType(obj);
 }
 
 jobject NativeJVM_Unix::NewObject(jclass cls, jmethodID constructor, jobject param) {
-    return m_env->NewObject(cls, constructor, param);
+    return env()->NewObject(cls, constructor, param);
 }
 
 jobject NativeJVM_Unix::NewObject(jclass cls, jmethodID constructor, jlong param) {
-	return m_env->NewObject(cls, constructor, param);
+	return env()->NewObject(cls, constructor, param);
 }
 
 jintArray NativeJVM_Unix::NewIntArray(int size) {
-	return m_env->NewIntArray(size);
+	return env()->NewIntArray(size);
 }
 
 jdoubleArray NativeJVM_Unix::NewDoubleArray(int size) {
-	return m_env->NewDoubleArray(size);
+	return env()->NewDoubleArray(size);
+}
+
+jlongArray NativeJVM_Unix::NewLongArray(int size) {
+	return env()->NewLongArray(size);
+}
+
+void NativeJVM_Unix::GetIntArrayRegion(jintArray arr, int start, int length, jint* buffer) {
+	env()->GetIntArrayRegion(arr, start, length, buffer);
+}
+
+void NativeJVM_Unix::GetDoubleArrayRegion(jdoubleArray arr, int start, int length, jdouble* buffer) {
+	env()->GetDoubleArrayRegion(arr, start, length, buffer);
+}
+
+void NativeJVM_Unix::GetLongArrayRegion(jlongArray arr, int start, int length, jlong* buffer) {
+	env()->GetLongArrayRegion(arr, start, length, buffer);
+}
+
+void NativeJVM_Unix::SetDoubleArrayRegion(jdoubleArray arr, int start, int length, const jdouble* buffer) {
+	env()->SetDoubleArrayRegion(arr, start, length, buffer);
 }
 
 jobjectArray NativeJVM_Unix::NewObjectArray(int size, jclass cls) {
-	return m_env->NewObjectArray(size, cls, nullptr);
+	return env()->NewObjectArray(size, cls, nullptr);
 }
 
 void NativeJVM_Unix::SetIntField(jobject obj, jfieldID fld, jint val) {
-	m_env->SetIntField(obj, fld, val);
+	env()->SetIntField(obj, fld, val);
 }
 
 void NativeJVM_Unix::SetDoubleField(jobject obj, jfieldID fld, jdouble val) {
-	m_env->SetDoubleField(obj, fld, val);
+	env()->SetDoubleField(obj, fld, val);
 }
 
 void NativeJVM_Unix::SetLongField(jobject obj, jfieldID fld, jlong val) {
-	m_env->SetLongField(obj, fld, val);
+	env()->SetLongField(obj, fld, val);
 }
 
 void NativeJVM_Unix::SetObjectField(jobject obj, jfieldID fld, jobject val) {
-	m_env->SetObjectField(obj, fld, val);
+	env()->SetObjectField(obj, fld, val);
 }
 
 void NativeJVM_Unix::SetObjectArrayElement(jobjectArray arr, int index, jobject val) {
-	m_env->SetObjectArrayElement(arr, index, val);
+	env()->SetObjectArrayElement(arr, index, val);
 }
 
 jobject NativeJVM_Unix::GetObjectField(jobject obj, jfieldID fid) {
-	return m_env->GetObjectField(obj, fid);
+	return env()->GetObjectField(obj, fid);
 }
 
 jint NativeJVM_Unix::GetIntField(jobject obj, jfieldID fid) {
-	return m_env->GetIntField(obj, fid);
+	return env()->GetIntField(obj, fid);
 }
 
 jdouble NativeJVM_Unix::GetDoubleField(jobject obj, jfieldID fid) {
-	return m_env->GetDoubleField(obj, fid);
+	return env()->GetDoubleField(obj, fid);
 }
 
 jlong NativeJVM_Unix::GetLongField(jobject obj, jfieldID fid) {
-	return m_env->GetLongField(obj, fid);
+	return env()->GetLongField(obj, fid);
 }
 
 jboolean NativeJVM_Unix::ExceptionCheck() {
-	return m_env->ExceptionCheck();
+	return env()->ExceptionCheck();
+}
+
+void NativeJVM_Unix::ExceptionClear() {
+	env()->ExceptionClear();
 }
@@ -97,16 +97,22 @@ static std::vector<std::string> dependencies =
   "SparseBitSet.jar", "weather.jar", "wtime.jar",
   "xmlbeans.jar" };
 
+/**
+ * Jars added to the class path only if they're installed. The wrapper's own adapter lets it copy
+ * data out of Java in bulk, without it the wrapper falls back to reading field by field.
+ */
+static std::vector<std::string> optionalDependencies =
+{ "REDappWrapperAdapter.jar" };
+
 
 class NativeJVM_Win : public NativeJVM {
 public:
 	JavaVM *m_jvm;
-	JNIEnv* m_env;
 	bool m_valid;
 	bool m_init;
 	unsigned long error_code;
 
-	NativeJVM_Win() : m_jvm(nullptr), m_env(nullptr), m_valid(false), m_init(false) { }
+	NativeJVM_Win() : m_jvm(nullptr), m_valid(false), m_init(false) { }
 	virtual ~NativeJVM_Win();
 
 	bool Initialize(const std::string& overridePath) override;
@@ -117,20 +123,27 @@ public:
 
 	void _initjava(fs::path libraryPath);
 
-	jclass FindClass(const std::string& signature) override;
-	jfieldID GetStaticFieldID(jclass clz, const std::string& name, const std::string& signature) override;
+	bool AttachCurrentThread() override;
+	bool AttachCurrentThreadAsDaemon() override;
+	void DetachCurrentThread() override;
+
+	jclass FindClass(const char* signature) override;
+	jfieldID GetStaticFieldID(jclass clz, const char* name, const char* signature) override;
 	jobject GetStaticObjectField(jclass clz, jfieldID fld) override;
-	jmethodID GetMethodID(jclass clz, const std::string& name, const std::string& signature) override;
-	jmethodID GetStaticMethodID(jclass clz, const std::string& name, const std::string& signature) override;
-	jfieldID GetFieldID(jclass clz, const std::string& name, const std::string& signature) override;
+	jmethodID GetMethodID(jclass clz, const char* name, const char* signature) override;
+	jmethodID GetStaticMethodID(jclass clz, const char* name, const char* signature) override;
+	jfieldID GetFieldID(jclass clz, const char* name, const char* signature) override;
 
 	jobject CallStaticObjectMethod(jclass cls, jmethodID mid, jobject param) override;
+	jobject CallStaticObjectMethodOOO(jclass cls, jmethodID mid, jobject o1, jobject o2, jobject o3) override;
 	jobject CallStaticObjectMethod(jclass cls, jmethodID mid, jint param) override;
 	jboolean CallStaticBooleanMethod(jclass cls, jmethodID mid, jobject param) override;
+	jboolean CallStaticBooleanMethodOOOO(jclass cls, jmethodID mid, jobject o1, jobject o2, jobject o3, jobject o4) override;
 	jobject CallObjectMethodO(jobject obj, jmethodID mid, jobject o) override;
 	jobject CallObjectMethodOO(jobject obj, jmethodID mid, jobject o1, jobject o2) override;
 	jobject CallObjectMethodOOI(jobject obj, jmethodID mid, jobject o1, jobject o2, jint i1) override;
 	jobject CallObjectMethod(jobject obj, jmethodID mid, jint ind) override;
+	jobject CallObjectMethodII(jobject obj, jmethodID mid, jint i1, jint i2) override;
 	jdouble CallDoubleMethod(jobject obj, jmethodID mid, ...) override;
 	jobject CallObjectDoubleMethod(jobject obj, jmethodID mid, ...) override;
 	jboolean CallBooleanMethod(jobject obj, jmethodID mid) override;
@@ -150,10 +163,18 @@ public:
 	jstring NewStringUTF(const char* str) override;
 	void DeleteLocalRef(jstring str) override;
 	void DeleteLocalRef(jobject str) override;
+	jobject NewGlobalRef(jobject obj) override;
+	void DeleteGlobalRef(jobject obj) override;
+	jobjectRefType GetObjectRefType(jobject obj) override;
 	jobject NewObject(jclass cls, jmethodID constructor, jobject param) override;
 	jobject NewObject(jclass cls, jmethodID constructor, jlong param) override;
 	jintArray NewIntArray(int size) override;
 	jdoubleArray NewDoubleArray(int size) override;
+	jlongArray NewLongArray(int size) override;
+	void GetIntArrayRegion(jintArray arr, int start, int length, jint* buffer) override;
+	void GetDoubleArrayRegion(jdoubleArray arr, int start, int length, jdouble* buffer) override;
+	void GetLongArrayRegion(jlongArray arr, int start, int length, jlong* buffer) override;
+	void SetDoubleArrayRegion(jdoubleArray arr, int start, int length, const jdouble* buffer) override;
 	jobjectArray NewObjectArray(int size, jclass cls) override;
 	void SetIntField(jobject obj, jfieldID fld, jint val) override;
 	void SetDoubleField(jobject obj, jfieldID fld, jdouble val) override;
@@ -165,15 +186,37 @@ public:
 	jdouble GetDoubleField(jobject obj, jfieldID fid) override;
 	jlong GetLongField(jobject obj, jfieldID fid) override;
 	jboolean ExceptionCheck() override;
+	void ExceptionClear() override;
 };
 
+/**
+ * The JNIEnv for the calling thread. Only valid on threads that created or have been attached to the JVM.
+ */
+static thread_local JNIEnv* t_env = nullptr;
+
+static inline JNIEnv* env() { return t_env; }
+
+/**
+ * Detaches threads that attached themselves as daemons when they exit.
+ */
+struct daemon_detach {
+	JavaVM* jvm = nullptr;
+
+	~daemon_detach() {
+		if (jvm && t_env)
+			jvm->DetachCurrentThread();
+		t_env = nullptr;
+	}
+};
+
+static thread_local daemon_detach t_detach;
+
 std::unique_ptr<NativeJVM> NativeJVM::construct() {
 	return std::unique_ptr<NativeJVM>{new NativeJVM_Win()};
 }
 
 NativeJVM_Win::~NativeJVM_Win() {
 	m_jvm = nullptr;
-	m_env = nullptr;
 }
 
 std::string exec(std::string_view cmd) {
@@ -453,7 +496,7 @@ bool NativeJVM_Win::Initialize(const std::string& overridePath) {
 }
 
 void NativeJVM_Win::InitializeVersion() {
-	jint ver = m_env->GetVersion();
+	jint ver = env()->GetVersion();
 	jint major = (ver >> 16) & 0xFFFF;
 	jint minor = ver & 0xFFFF;
 	javaVersion = std::to_string(major) + "." + std::to_string(minor);
@@ -549,6 +592,13 @@ void NativeJVM_Win::_initjava(fs::path libraryPath) {
 		key += p.string();
 		key += ";";
 	}
+	for (auto& dep : optionalDependencies) {
+		p = p.replace_filename(dep);
+		if (fs::exists(p)) {
+			key += p.string();
+			key += ";";
+		}
+	}
 	std::replace(key.begin(), key.end(), '\\', '/');
 	options[0].optionString = const_cast<char*>(key.c_str());
 #ifdef _DEBUG
@@ -563,7 +613,7 @@ void NativeJVM_Win::_initjava(fs::path libraryPath) {
 	jvmError = CreateJavaVM(&jvm, (void**)&env, &vm_args, &error_code);
 	delete[] options;
 	if (jvmError == JNI_OK && jvm && env) {
-		m_env = env;
+		t_env = env;
 		m_jvm = jvm;
 		m_valid = internalError != ERROR_MISSING_JAR;
 		javaPath = libraryPath.parent_path().parent_path().string();
@@ -589,62 +639,107 @@ void NativeJVM_Win::_initjava(fs::path libraryPath) {
 	}
 }
 
-jclass NativeJVM_Win::FindClass(const std::string& signature) {
-	return m_env->FindClass(signature.c_str());
+bool NativeJVM_Win::AttachCurrentThread() {
+	if (t_env)
+		return true;
+	if (!m_jvm)
+		return false;
+	JNIEnv* e;
+	if (m_jvm->AttachCurrentThread((void**)&e, nullptr) != JNI_OK)
+		return false;
+	t_env = e;
+	return true;
+}
+
+bool NativeJVM_Win::AttachCurrentThreadAsDaemon() {
+	if (t_env)
+		return true;
+	if (!m_jvm)
+		return false;
+	JNIEnv* e;
+	if (m_jvm->AttachCurrentThreadAsDaemon((void**)&e, nullptr) != JNI_OK)
+		return false;
+	t_env = e;
+	t_detach.jvm = m_jvm;
+	return true;
+}
+
+void NativeJVM_Win::DetachCurrentThread() {
+	if (t_env && m_jvm) {
+		m_jvm->DetachCurrentThread();
+		t_env = nullptr;
+		t_detach.jvm = nullptr;
+	}
+}
+
+jclass NativeJVM_Win::FindClass(const char* signature) {
+	return env()->FindClass(signature);
 }
 
-jfieldID NativeJVM_Win::GetStaticFieldID(jclass clz, const std::string& name, const std::string& signature) {
-	return m_env->GetStaticFieldID(clz, name.c_str(), signature.c_str());
+jfieldID NativeJVM_Win::GetStaticFieldID(jclass clz, const char* name, const char* signature) {
+	return env()->GetStaticFieldID(clz, name, signature);
 }
 
 jobject NativeJVM_Win::GetStaticObjectField(jclass clz, jfieldID fld) {
-	return m_env->GetStaticObjectField(clz, fld);
+	return env()->GetStaticObjectField(clz, fld);
 }
 
-jmethodID NativeJVM_Win::GetMethodID(jclass clz, const std::string& name, const std::string& signature) {
-	return m_env->GetMethodID(clz, name.c_str(), signature.c_str());
+jmethodID NativeJVM_Win::GetMethodID(jclass clz, const char* name, const char* signature) {
+	return env()->GetMethodID(clz, name, signature);
 }
 
-jmethodID NativeJVM_Win::GetStaticMethodID(jclass clz, const std::string& name, const std::string& signature) {
-	return m_env->GetStaticMethodID(clz, name.c_str(), signature.c_str());
+jmethodID NativeJVM_Win::GetStaticMethodID(jclass clz, const char* name, const char* signature) {
+	return env()->GetStaticMethodID(clz, name, signature);
 }
 
-jfieldID NativeJVM_Win::GetFieldID(jclass clz, const std::string& name, const std::string& signature) {
-	return m_env->GetFieldID(clz, name.c_str(), signature.c_str());
+jfieldID NativeJVM_Win::GetFieldID(jclass clz, const char* name, const char* signature) {
+	return env()->GetFieldID(clz, name, signature);
 }
 
 jobject NativeJVM_Win::CallStaticObjectMethod(jclass cls, jmethodID mid, jobject param) {
-	return m_env->CallStaticObjectMethod(cls, mid, param);
+	return env()->CallStaticObjectMethod(cls, mid, param);
+}
+
+jobject NativeJVM_Win::CallStaticObjectMethodOOO(jclass cls, jmethodID mid, jobject o1, jobject o2, jobject o3) {
+	return env()->CallStaticObjectMethod(cls, mid, o1, o2, o3);
 }
 
 jobject NativeJVM_Win::CallStaticObjectMethod(jclass cls, jmethodID mid, jint param) {
-	return m_env->CallStaticObjectMethod(cls, mid, param);
+	return env()->CallStaticObjectMethod(cls, mid, param);
 }
 
 jboolean NativeJVM_Win::CallStaticBooleanMethod(jclass cls, jmethodID mid, jobject param) {
-	return m_env->CallStaticBooleanMethod(cls, mid, param);
+	return env()->CallStaticBooleanMethod(cls, mid, param);
+}
+
+jboolean NativeJVM_Win::CallStaticBooleanMethodOOOO(jclass cls, jmethodID mid, jobject o1, jobject o2, jobject o3, jobject o4) {
+	return env()->CallStaticBooleanMethod(cls, mid, o1, o2, o3, o4);
 }
 
 jobject NativeJVM_Win::CallObjectMethodO(jobject obj, jmethodID mid, jobject o) {
-	return m_env->CallObjectMethod(obj, mid, o);
+	return env()->CallObjectMethod(obj, mid, o);
 }
 
 jobject NativeJVM_Win::CallObjectMethodOO(jobject obj, jmethodID mid, jobject o1, jobject o2) {
-	return m_env->CallObjectMethod(obj, mid, o1, o2);
+	return env()->CallObjectMethod(obj, mid, o1, o2);
 }
 
 jobject NativeJVM_Win::CallObjectMethodOOI(jobject obj, jmethodID mid, jobject o1, jobject o2, jint i1) {
-	return m_env->CallObjectMethod(obj, mid, o1, o2, i1);
+	return env()->CallObjectMethod(obj, mid, o1, o2, i1);
 }
 
 jobject NativeJVM_Win::CallObjectMethod(jobject obj, jmethodID mid, jint ind) {
-	return m_env->CallObjectMethod(obj, mid, ind);
+	return env()->CallObjectMethod(obj, mid, ind);
+}
+
+jobject NativeJVM_Win::CallObjectMethodII(jobject obj, jmethodID mid, jint i1, jint i2) {
+	return env()->CallObjectMethod(obj, mid, i1, i2);
 }
 
 jdouble NativeJVM_Win::CallDoubleMethod(jobject obj, jmethodID mid, ...) {
 	va_list vl;
 	va_start(vl, mid);
-	jdouble jd = m_env->CallDoubleMethod(obj, mid, vl);
+	jdouble jd = env()->CallDoubleMethod(obj, mid, vl);
 	va_end(vl);
 	return jd;
 }
@@ -652,135 +747,171 @@ jdouble NativeJVM_Win::CallDoubleMethod(jobject obj, jmethodID mid, ...) {
 jobject NativeJVM_Win::CallObjectDoubleMethod(jobject obj, jmethodID mid, ...) {
 	va_list vl;
 	va_start(vl, mid);
-	jobject jo = m_env->CallObjectMethod(obj, mid, vl);
+	jobject jo = env()->CallObjectMethod(obj, mid, vl);
 	va_end(vl);
 	return jo;
 }
 
 jboolean NativeJVM_Win::CallBooleanMethod(jobject obj, jmethodID mid) {
-	return m_env->CallBooleanMethod(obj, mid);
+	return env()->CallBooleanMethod(obj, mid);
 }
 
 jboolean NativeJVM_Win::CallBooleanMethod(jobject obj, jmethodID mid, int param) {
-	return m_env->CallBooleanMethod(obj, mid, param);
+	return env()->CallBooleanMethod(obj, mid, param);
 }
 
 jint NativeJVM_Win::CallIntMethod(jobject obj, jmethodID mid) {
-	return m_env->CallIntMethod(obj, mid);
+	return env()->CallIntMethod(obj, mid);
 }
 
 jint NativeJVM_Win::CallIntMethod(jobject obj, jmethodID mid, jint param) {
-	return m_env->CallIntMethod(obj, mid, param);
+	return env()->CallIntMethod(obj, mid, param);
 }
 
 jlong NativeJVM_Win::CallLongMethod(jobject obj, jmethodID mid) {
-	return m_env->CallLongMethod(obj, mid);
+	return env()->CallLongMethod(obj, mid);
 }
 
 void NativeJVM_Win::CallMethod(jobject obj, jmethodID mid, jobject param) {
-	return m_env->CallVoidMethod(obj, mid, param);
+	return env()->CallVoidMethod(obj, mid, param);
 }
 
 void NativeJVM_Win::CallMethod(jobject obj, jmethodID mid, jint param) {
-	return m_env->CallVoidMethod(obj, mid, param);
+	return env()->CallVoidMethod(obj, mid, param);
 }
 
 void NativeJVM_Win::CallMethod(jobject obj, jmethodID mid, jint param1, jint param2) {
-	return m_env->CallVoidMethod(obj, mid, param1, param2);
+	return env()->CallVoidMethod(obj, mid, param1, param2);
 }
 
 void NativeJVM_Win::CallMethod(jobject obj, jmethodID mid, jdouble param) {
-	return m_env->CallVoidMethod(obj, mid, param);
+	return env()->CallVoidMethod(obj, mid, param);
 }
 
 void NativeJVM_Win::CallMethod(jobject obj, jmethodID mid, jlong param) {
-	return m_env->CallVoidMethod(obj, mid, param);
+	return env()->CallVoidMethod(obj, mid, param);
 }
 
 int NativeJVM_Win::GetArrayLength(jarray arr) {
-	return m_env->GetArrayLength(arr);
+	return env()->GetArrayLength(arr);
 }
 
 jobject NativeJVM_Win::GetObjectArrayElement(jobjectArray arr, int index) {
-	return m_env->GetObjectArrayElement(arr, index);
+	return env()->GetObjectArrayElement(arr, index);
 }
 
 const char* NativeJVM_Win::GetStringUTFChars(jstring str) {
-	return m_env->GetStringUTFChars(str, nullptr);
+	return env()->GetStringUTFChars(str, nullptr);
 }
 
 void NativeJVM_Win::ReleaseStringUTFChars(jstring str, const char* s) {
-	return m_env->ReleaseStringUTFChars(str, s);
+	return env()->ReleaseStringUTFChars(str, s);
 }
 
 jstring NativeJVM_Win::NewStringUTF(const char* str) {
-	return m_env->NewStringUTF(str);
+	return env()->NewStringUTF(str);
 }
 
 void NativeJVM_Win::DeleteLocalRef(jstring str) {
-	return m_env->DeleteLocalRef(str);
+	return env()->DeleteLocalRef(str);
 }
 
 void NativeJVM_Win::DeleteLocalRef(jobject str) {
-	return m_env->DeleteLocalRef(str);
+	return env()->DeleteLocalRef(str);
+}
+
+jobject NativeJVM_Win::NewGlobalRef(jobject obj) {
+	return env()->NewGlobalRef(obj);
+}
+
+void NativeJVM_Win::DeleteGlobalRef(jobject obj) {
+	return env()->DeleteGlobalRef(obj);
+}
+
+jobjectRefType NativeJVM_Win::GetObjectRefType(jobject obj) {
+	return env()->GetObjectRefType(obj);
 }
 
 jobject NativeJVM_Win::NewObject(jclass cls, jmethodID constructor, jobject param) {
-	return m_env->NewObject(cls, constructor, param);
+	return env()->NewObject(cls, constructor, param);
 }
 
 jobject NativeJVM_Win::NewObject(jclass cls, jmethodID constructor, jlong param) {
-	return m_env->NewObject(cls, constructor, param);
+	return env()->NewObject(cls, constructor, param);
 }
 
 jintArray NativeJVM_Win::NewIntArray(int size) {
-	return m_env->NewIntArray(size);
+	return env()->NewIntArray(size);
 }
 
 jdoubleArray NativeJVM_Win::NewDoubleArray(int size) {
-	return m_env->NewDoubleArray(size);
+	return env()->NewDoubleArray(size);
+}
+
+jlongArray NativeJVM_Win::NewLongArray(int size) {
+	return env()->NewLongArray(size);
+}
+
+void NativeJVM_Win::GetIntArrayRegion(jintArray arr, int start, int length, jint* buffer) {
+	env()->GetIntArrayRegion(arr, start, length, buffer);
+}
+
+void NativeJVM_Win::GetDoubleArrayRegion(jdoubleArray arr, int start, int length, jdouble* buffer) {
+	env()->GetDoubleArrayRegion(arr, start, length, buffer);
+}
+
+void NativeJVM_Win::GetLongArrayRegion(jlongArray arr, int start, int length, jlong* buffer) {
+	env()->GetLongArrayRegion(arr, start, length, buffer);
+}
+
+void NativeJVM_Win::SetDoubleArrayRegion(jdoubleArray arr, int start, int length, const jdouble* buffer) {
+	env()->SetDoubleArrayRegion(arr, start, length, buffer);
 }
 
 jobjectArray NativeJVM_Win::NewObjectArray(int size, jclass cls) {
-	return m_env->NewObjectArray(size, cls, nullptr);
+	return env()->NewObjectArray(size, cls, nullptr);
 }
 
 void NativeJVM_Win::SetIntField(jobject obj, jfieldID fld, jint val) {
-	m_env->SetIntField(obj, fld, val);
+	env()->SetIntField(obj, fld, val);
 }
 
 void NativeJVM_Win::SetDoubleField(jobject obj, jfieldID fld, jdouble val) {
-	m_env->SetDoubleField(obj, fld, val);
+	env()->SetDoubleField(obj, fld, val);
 }
 
 void NativeJVM_Win::SetLongField(jobject obj, jfieldID fld, jlong val) {
-	m_env->SetLongField(obj, fld, val);
+	env()->SetLongField(obj, fld, val);
 }
 
 void NativeJVM_Win::SetObjectField(jobject obj, jfieldID fld, jobject val) {
-	m_env->SetObjectField(obj, fld, val);
+	env()->SetObjectField(obj, fld, val);
 }
 
 void NativeJVM_Win::SetObjectArrayElement(jobjectArray arr, int index, jobject val) {
-	m_env->SetObjectArrayElement(arr, index, val);
+	env()->SetObjectArrayElement(arr, index, val);
 }
 
 jobject NativeJVM_Win::GetObjectField(jobject obj, jfieldID fid) {
-	return m_env->GetObjectField(obj, fid);
+	return env()->GetObjectField(obj, fid);
 }
 
 jint NativeJVM_Win::GetIntField(jobject obj, jfieldID fid) {
-	return m_env->GetIntField(obj, fid);
+	return env()->GetIntField(obj, fid);
 }
 
 jdouble NativeJVM_Win::GetDoubleField(jobject obj, jfieldID fid) {
-	return m_env->GetDoubleField(obj, fid);
+	return env()->GetDoubleField(obj, fid);
 }
 
 jlong NativeJVM_Win::GetLongField(jobject obj, jfieldID fid) {
-	return m_env->GetLongField(obj, fid);
+	return env()->GetLongField(obj, fid);
 }
 
 jboolean NativeJVM_Win::ExceptionCheck() {
-	return m_env->ExceptionCheck();
+	return env()->ExceptionCheck();
+}
+
+void NativeJVM_Win::ExceptionClear() {
+	env()->ExceptionClear();
 }
@@ -0,0 +1,58 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: mapped_file_unix.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& filename) {
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		::close(fd);
+		return nullptr;
+	}
+
+	std::unique_ptr<MappedFile> retval(new MappedFile());
+	//an empty file can't be mapped but is still a valid file
+	if (st.st_size > 0) {
+		void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			::close(fd);
+			return nullptr;
+		}
+		madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+		retval->m_data = static_cast<const char*>(data);
+		retval->m_size = (size_t)st.st_size;
+	}
+	//the mapping stays valid after the descriptor is closed
+	::close(fd);
+	return retval;
+}
+
+MappedFile::~MappedFile() {
+	if (m_data)
+		munmap(const_cast<char*>(m_data), m_size);
+}
@@ -0,0 +1,64 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: mapped_file_win.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapped_file.h"
+
+#include <Windows.h>
+
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& filename) {
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	std::unique_ptr<MappedFile> retval(new MappedFile());
+	//an empty file can't be mapped but is still a valid file
+	if (size.QuadPart > 0) {
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			CloseHandle(file);
+			return nullptr;
+		}
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return nullptr;
+		}
+		retval->m_data = static_cast<const char*>(data);
+		retval->m_size = (size_t)size.QuadPart;
+		retval->m_handle = mapping;
+	}
+	//the view stays valid after the file handle is closed
+	CloseHandle(file);
+	return retval;
+}
+
+MappedFile::~MappedFile() {
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_handle)
+		CloseHandle((HANDLE)m_handle);
+}
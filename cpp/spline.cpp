@@ -0,0 +1,105 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: spline.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spline.h"
+
+#include <cmath>
+
+
+bool NaturalCubicSpline::setKnots(const double* houroffsets, int size) {
+	if (size < 2)
+		return false;
+	for (int i = 0; i < size; i++) {
+		if (!std::isfinite(houroffsets[i]) || (i > 0 && houroffsets[i] <= houroffsets[i - 1]))
+			return false;
+	}
+
+	m_x.assign(houroffsets, houroffsets + size);
+	m_h.resize(size - 1);
+	for (int i = 0; i < size - 1; i++)
+		m_h[i] = m_x[i + 1] - m_x[i];
+
+	//forward elimination for the interior second derivatives, the ends are zero for a natural spline
+	int interior = size - 2;
+	m_cp.resize(interior);
+	m_invDenom.resize(interior);
+	for (int k = 0; k < interior; k++) {
+		double a = m_h[k];
+		double b = 2.0 * (m_h[k] + m_h[k + 1]);
+		double c = m_h[k + 1];
+		double denom = k == 0 ? b : b - a * m_cp[k - 1];
+		m_invDenom[k] = 1.0 / denom;
+		m_cp[k] = c * m_invDenom[k];
+	}
+	m_y.assign(size, 0.0);
+	m_m.assign(size, 0.0);
+	return true;
+}
+
+void NaturalCubicSpline::fit(const double* values) {
+	int size = (int)m_x.size();
+	int interior = size - 2;
+	m_y.assign(values, values + size);
+	m_m[0] = 0.0;
+	m_m[size - 1] = 0.0;
+
+	//m_m doubles as the forward substitution scratch for the interior points
+	for (int k = 0; k < interior; k++) {
+		double d = 6.0 * ((m_y[k + 2] - m_y[k + 1]) / m_h[k + 1] - (m_y[k + 1] - m_y[k]) / m_h[k]);
+		double prev = k == 0 ? 0.0 : m_m[k];
+		m_m[k + 1] = (d - m_h[k] * prev) * m_invDenom[k];
+	}
+	for (int k = interior - 2; k >= 0; k--)
+		m_m[k + 1] -= m_cp[k] * m_m[k + 2];
+}
+
+int NaturalCubicSpline::firstHour() const {
+	return (int)std::ceil(m_x.front());
+}
+
+int NaturalCubicSpline::lastHour() const {
+	return (int)std::floor(m_x.back());
+}
+
+void NaturalCubicSpline::evaluateHours(double* result) const {
+	int size = (int)m_x.size();
+	int first = firstHour();
+	int last = lastHour();
+	int hour = first;
+	for (int i = 0; i < size - 1 && hour <= last; i++) {
+		//the hours in this segment, the last segment also includes its end point
+		int end = i == size - 2 ? last + 1 : (int)std::ceil(m_x[i + 1]);
+		if (end > last + 1)
+			end = last + 1;
+		const double x0 = m_x[i], x1 = m_x[i + 1], h = m_h[i];
+		const double a = m_m[i] / (6.0 * h);
+		const double b = m_m[i + 1] / (6.0 * h);
+		const double c = m_y[i] / h - m_m[i] * h / 6.0;
+		const double d = m_y[i + 1] / h - m_m[i + 1] * h / 6.0;
+		double* out = result + (hour - first);
+		const int count = end - hour;
+		//no dependencies between iterations so the compiler can vectorize this loop
+		for (int j = 0; j < count; j++) {
+			const double t = (double)(hour + j);
+			const double l = x1 - t;
+			const double r = t - x0;
+			out[j] = a * l * l * l + b * r * r * r + c * l + d * r;
+		}
+		hour = end;
+	}
+}
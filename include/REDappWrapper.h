@@ -4,6 +4,17 @@
 #include <cstdint>
 #include <string>
 #include <stdexcept>
+#include <future>
+#include <memory>
+#include <map>
+#include <functional>
+#include <coroutine>
+#include <chrono>
+#include <new>
+#include <span>
+#include <memory_resource>
+#include <atomic>
+#include <optional>
 
 
 #ifdef _MSC_VER
@@ -69,6 +80,116 @@ struct WeatherCollection {
 	}
 };
 
+/**
+An allocator that starts every allocation on its own cache line, taking the memory from a
+polymorphic memory resource.
+ */
+template<typename T>
+struct CacheAlignedAllocator {
+	typedef T value_type;
+	static constexpr std::size_t alignment = 64;
+
+	std::pmr::memory_resource* resource;
+
+	CacheAlignedAllocator(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept : resource(resource) { }
+	template<typename U>
+	CacheAlignedAllocator(const CacheAlignedAllocator<U>& other) noexcept : resource(other.resource) { }
+
+	T* allocate(std::size_t n) { return static_cast<T*>(resource->allocate(n * sizeof(T), alignment)); }
+	void deallocate(T* p, std::size_t n) noexcept { resource->deallocate(p, n * sizeof(T), alignment); }
+
+	template<typename U>
+	bool operator==(const CacheAlignedAllocator<U>& other) const noexcept { return *resource == *other.resource; }
+};
+
+/**
+A read only window onto some or all of a WeatherSeries. Views don't own any data and are only
+valid while the series they came from is alive and hasn't been resized.
+ */
+struct REDAPP_EXPORT WeatherSeriesView {
+	std::span<const double> hour;
+	std::span<const uint_fast64_t> epoch;
+	std::span<const double> temp;
+	std::span<const double> rh;
+	std::span<const double> wd;
+	std::span<const double> ws;
+	std::span<const double> wg;
+	std::span<const double> precip;
+	std::span<const double> ffmc;
+	std::span<const double> DMC;
+	std::span<const double> DC;
+	std::span<const double> BUI;
+	std::span<const double> ISI;
+	std::span<const double> FWI;
+	std::span<const int> options;
+
+	inline std::size_t size() const { return epoch.size(); }
+	/**
+	Get a view of count hours starting at offset.
+	 */
+	WeatherSeriesView subview(std::size_t offset, std::size_t count) const;
+};
+
+/**
+Hourly weather stored one column per variable instead of one struct per hour. Each column is a
+separate cache line aligned array, so scanning a single variable only touches that variable.
+ */
+class REDAPP_EXPORT WeatherSeries {
+public:
+	template<typename T>
+	using Column = std::vector<T, CacheAlignedAllocator<T>>;
+
+	/**
+	Create an empty series. The columns are allocated from resource, or from the library wide
+	memory resource if it is nullptr.
+	 */
+	WeatherSeries() : WeatherSeries(nullptr) { }
+	explicit WeatherSeries(std::pmr::memory_resource* resource);
+	explicit WeatherSeries(std::size_t size, std::pmr::memory_resource* resource = nullptr) : WeatherSeries(resource) { resize(size); }
+	/**
+	Copy an array of weather collections into a new series.
+	 */
+	WeatherSeries(const WeatherCollection* data, std::size_t size, std::pmr::memory_resource* resource = nullptr);
+
+	inline std::size_t size() const { return epoch.size(); }
+	inline bool empty() const { return epoch.empty(); }
+	/**
+	Change the number of hours in the series. New hours have the same defaults as a new WeatherCollection.
+	 */
+	void resize(std::size_t size);
+	void clear();
+
+	/**
+	Get or replace a single hour as a weather collection.
+	 */
+	WeatherCollection at(std::size_t index) const;
+	void set(std::size_t index, const WeatherCollection& value);
+	/**
+	Copy the series into an array of weather collections. data must hold at least size() entries.
+	 */
+	void copyTo(WeatherCollection* data) const;
+	std::vector<WeatherCollection> toCollection() const;
+
+	WeatherSeriesView view() const;
+	inline WeatherSeriesView view(std::size_t offset, std::size_t count) const { return view().subview(offset, count); }
+
+	NOT_EXPORTED(Column<double> hour)
+	NOT_EXPORTED(Column<uint_fast64_t> epoch)
+	NOT_EXPORTED(Column<double> temp)
+	NOT_EXPORTED(Column<double> rh)
+	NOT_EXPORTED(Column<double> wd)
+	NOT_EXPORTED(Column<double> ws)
+	NOT_EXPORTED(Column<double> wg)
+	NOT_EXPORTED(Column<double> precip)
+	NOT_EXPORTED(Column<double> ffmc)
+	NOT_EXPORTED(Column<double> DMC)
+	NOT_EXPORTED(Column<double> DC)
+	NOT_EXPORTED(Column<double> BUI)
+	NOT_EXPORTED(Column<double> ISI)
+	NOT_EXPORTED(Column<double> FWI)
+	NOT_EXPORTED(Column<int> options)
+};
+
 #ifdef _MSC_VER
 #define _GCC_NOTHROW 
 #else
@@ -84,6 +205,71 @@ public:
 
 
 namespace REDapp {
+/**
+A callback for an asynchronous call. It is run on the Java worker thread that completed the
+call and is passed a ready future, calling get() on it returns the result or rethrows any
+exception the call raised. Should return quickly since it holds up the worker.
+ */
+template<typename T>
+using Completion = std::function<void(std::future<T>)>;
+
+/**
+Resumes a suspended coroutine, for example by posting it to an event loop. If no executor is
+given coroutines are resumed by ResumeCoroutine, never on a Java worker thread.
+ */
+using Executor = std::function<void(std::coroutine_handle<>)>;
+
+/**
+Resume a coroutine on a small pool of threads shared by the whole library. The threads are
+started the first time a coroutine is resumed and stopped when the library is unloaded.
+ */
+REDAPP_EXPORT void ResumeCoroutine(std::coroutine_handle<> handle);
+
+/**
+An asynchronous call that can be co_await-ed. The calling coroutine is suspended while the call
+runs on a Java worker thread and is resumed through its executor when the call completes.
+co_await returns the result or rethrows any exception the call raised.
+ */
+template<typename T>
+class Awaitable {
+public:
+	typedef std::function<void(Completion<T>)> starter_t;
+
+	Awaitable(starter_t start, Executor executor) : m_start(std::move(start)), m_executor(std::move(executor)) { }
+
+	bool await_ready() const noexcept { return false; }
+
+	/**
+	The call can complete before m_start has returned, and resuming the coroutine destroys this
+	awaitable. Whichever of the two finishes second resumes it: the completion if the call was
+	already started, otherwise this returns false and the coroutine carries on without suspending.
+	 */
+	bool await_suspend(std::coroutine_handle<> handle) {
+		m_start([this, handle](std::future<T> result) {
+			m_result = std::move(result);
+			Executor executor = std::move(m_executor);
+			if (m_state.exchange(COMPLETED, std::memory_order_acq_rel) != STARTED)
+				return;
+			if (executor)
+				executor(handle);
+			else
+				ResumeCoroutine(handle);
+		});
+		return m_state.exchange(STARTED, std::memory_order_acq_rel) != COMPLETED;
+	}
+
+	T await_resume() { return m_result.get(); }
+
+private:
+	enum State { STARTING, STARTED, COMPLETED };
+
+private:
+	starter_t m_start;
+	Executor m_executor;
+	std::future<T> m_result;
+	std::atomic<State> m_state{ STARTING };
+};
+
 struct REDAPP_EXPORT JavaClassDef {
 	void* data;
 	NOT_EXPORTED(std::string name)
@@ -93,18 +279,26 @@ class REDAPP_EXPORT JavaObject {
 protected:
 	void* _internal;
 	JavaClassDef _type;
-	bool m_isnew;
+	/**
+	Shared by every copy of an object that owns its Java reference, the reference is deleted
+	when the last of them is disposed.
+	 */
+	NOT_EXPORTED(std::shared_ptr<void> m_owner)
 
 public:
 	inline bool isValid() { return (_internal != nullptr) && (_type.data != nullptr); }
-	inline void requiresDelete(bool del) { m_isnew = del; }
+	/**
+	Whether the Java reference is deleted once this object and every copy of it are gone.
+	Turning it off stops the reference being deleted by any of the copies.
+	 */
+	void requiresDelete(bool del);
 
 	void dispose();
 
 public:
-	JavaObject(void* internal, JavaClassDef type) { this->_internal = internal; this->_type = type; this->m_isnew = false; }
-	JavaObject(const JavaObject& toCopy) { this->_internal = toCopy._internal; this->_type = toCopy._type; this->m_isnew = false; }
-	JavaObject& operator=(const JavaObject& toCopy) { if (&toCopy != this) { this->_internal = toCopy._internal; this->_type = toCopy._type; this->m_isnew = false; } return *this; }
+	JavaObject(void* internal, JavaClassDef type) { this->_internal = internal; this->_type = type; }
+	JavaObject(const JavaObject& toCopy) { this->_internal = toCopy._internal; this->_type = toCopy._type; this->m_owner = toCopy.m_owner; }
+	JavaObject& operator=(const JavaObject& toCopy) { if (&toCopy != this) { dispose(); this->_internal = toCopy._internal; this->_type = toCopy._type; this->m_owner = toCopy.m_owner; } return *this; }
 	~JavaObject() { dispose(); }
 };
 
@@ -112,10 +306,74 @@ class REDAPP_EXPORT Interpolator : public JavaObject {
 	friend class REDappWrapper;
 
 public:
+	/**
+	Which implementation computes the spline.
+	 */
+	enum class SplineEngine {
+		/**
+		Always interpolate through Java.
+		 */
+		JAVA = 0,
+		/**
+		Interpolate natively and fall back to Java for input the native spline doesn't accept,
+		fewer than two points or hour offsets that aren't strictly increasing. The native spline
+		is a natural cubic spline and is only known to match Java where the spline_engines test
+		passes against the REDapp library in use, use VERIFY to check real data first.
+		 */
+		NATIVE = 1,
+		/**
+		Interpolate with both and compare the results. The Java result is always the one
+		returned, differences larger than SplineTolerance are counted in the spline statistics.
+		 */
+		VERIFY = 2
+	};
+
+	/**
+	The largest difference, relative to the magnitude of the value, allowed between a native
+	and a Java interpolated value.
+	 */
+	static constexpr double SplineTolerance = 1e-9;
+
+	/**
+	One set of hourly values to interpolate with SplineInterpolateMany. Series that interpolate
+	different variables at the same hours can point at the same offsets.
+	 */
+	struct SplineSeries {
+		const double* houroffsets{ nullptr };
+		const double* values{ nullptr };
+		int size{ 0 };
+	};
+
 	Interpolator();
 	virtual ~Interpolator() { }
 
+	/**
+	Choose which implementation computes the spline. Defaults to SplineEngine::JAVA.
+	 */
+	inline void setEngine(SplineEngine engine) { m_engine = engine; }
+
 	std::vector<std::pair<int, double>> SplineInterpolate(double* houroffsets, double* values, int size);
+	/**
+	Interpolate into a vector allocated from resource, or from the library wide memory resource
+	if it is nullptr.
+	 */
+	std::pmr::vector<std::pair<int, double>> SplineInterpolate(double* houroffsets, double* values, int size, std::pmr::memory_resource* resource);
+	/**
+	Interpolate on a Java worker thread from a coroutine. The arrays and the interpolator must
+	stay valid until the awaiting coroutine resumes.
+	 */
+	Awaitable<std::vector<std::pair<int, double>>> SplineInterpolateAwait(double* houroffsets, double* values, int size, Executor executor = nullptr);
+	/**
+	Interpolate many series at once. The results are in the same order as series. Series that
+	share hour offsets are handled together: with the native engine the spline is only factored
+	once for them and the groups are split between the calling thread and helper threads,
+	otherwise each group goes to Java in one transaction on one of the Java worker threads. The
+	arrays must stay valid until the call returns.
+	 */
+	std::vector<std::vector<std::pair<int, double>>> SplineInterpolateMany(const std::vector<SplineSeries>& series);
+
+private:
+	SplineEngine m_engine{ SplineEngine::JAVA };
 };
 
 class REDAPP_EXPORT Cities : public JavaObject {
@@ -128,22 +386,36 @@ public:
 	inline const char* name() const { return m_name.c_str(); }
 
 	Cities(const std::string& name, void* internal) : JavaObject(internal, JavaClassDef()) { this->m_name = name; }
-	Cities(const Cities& toCopy) : JavaObject(toCopy._internal, JavaClassDef()) { this->m_name = toCopy.m_name; }
+	Cities(const Cities& toCopy) : JavaObject(toCopy) { this->m_name = toCopy.m_name; }
 	Cities& operator=(const Cities& toCopy) { JavaObject::operator=(toCopy); this->m_name = toCopy.m_name; return *this; }
 };
 
 /**
 Stores location information for use in getting forecast weather from weatheroffice.gc.ca.
  */
+enum class REDAPP_EXPORT Province : short int;
+
 class REDAPP_EXPORT LocationSmall : public JavaObject {
 	friend class REDappWrapper;
 	friend class ForecastCalculator;
 
 public:
 	LocationSmall(void* internal, JavaClassDef type) : JavaObject(internal, type) { }
+	LocationSmall(void* internal, JavaClassDef type, const std::string& name, Province prov) : JavaObject(internal, type), m_name(name), m_province(prov) { }
 
 public:
 	STANDARD_STRING_FIELD_DEFINITION(locationName)
+
+private:
+	/**
+	The location name, read when the location is fetched so it doesn't need to be read from Java again.
+	 */
+	NOT_EXPORTED(std::string m_name)
+	/**
+	The province the location was fetched for, if it's known. Location names are only unique
+	within a province.
+	 */
+	NOT_EXPORTED(std::optional<Province> m_province)
 };
 
 /**
@@ -250,12 +522,46 @@ enum class REDAPP_EXPORT Time : short int {
 	NOON
 };
 
+/**
+A date and time kept natively. Calendars are UTC unless they wrap a Java calendar in another time
+zone. A Java calendar is only created when one has to be passed to Java. Months are zero based to
+match java.util.Calendar, and setting a field out of range rolls over into the next field.
+ */
 class REDAPP_EXPORT Calendar : public JavaObject {
 	friend class ForecastCalculator;
 
 public:
+	typedef std::chrono::sys_time<std::chrono::milliseconds> time_type;
+
+	/**
+	The fields of a calendar. month is zero based.
+	 */
+	struct DateTime {
+		int year;
+		int month;
+		int day;
+		int hour;
+		int minute;
+		int second;
+	};
+
+	/**
+	The current time in UTC.
+	 */
 	Calendar();
-	Calendar(void* internal, JavaClassDef type) : JavaObject(internal, type) { }
+	explicit Calendar(time_type time) : JavaObject(nullptr, JavaClassDef()), m_time(time), m_offset(0), m_resolved(true) { }
+	/**
+	Wrap a Java calendar. Its time and time zone offset are read in a single call the first
+	time they are needed.
+	 */
+	Calendar(void* internal, JavaClassDef type) : JavaObject(internal, type), m_offset(0), m_resolved(false) { }
+
+	/**
+	Always true. The date and time are kept natively, so unlike other Java objects a calendar
+	that doesn't wrap a Java calendar is still usable. This deliberately hides
+	JavaObject::isValid.
+	 */
+	inline bool isValid() { return true; }
 
 	void setYear(int year);
 	void setMonth(int month);
@@ -263,6 +569,11 @@ public:
 	void setHour(int hour);
 	void setMinute(int min);
 	void setSeconds(int sec);
+	void setTime(time_type time);
+	/**
+	Set the whole date and time at once. month is zero based.
+	 */
+	void setDateTime(int year, int month, int day, int hour, int min, int sec);
 
 	int getYear();
 	int getMonth();
@@ -270,9 +581,101 @@ public:
 	int getHour();
 	int getMinute();
 	int getSeconds();
+	time_type getTime();
+	/**
+	Get the whole date and time at once.
+	 */
+	DateTime getDateTime();
+	/**
+	The offset of the calendar's time zone from UTC.
+	 */
+	std::chrono::milliseconds getZoneOffset();
 
 	std::string toString();
-	void fromString(const std::string& val);
+	/**
+	Parse a date in the format yyyyMMddHHmmss z, where z is a UTC offset or a time zone name.
+	Returns false and leaves the calendar unchanged if val can't be parsed.
+	 */
+	bool fromString(const std::string& val);
+
+private:
+	void resolve();
+	void setField(int field, int value);
+	int getField(int field);
+
+private:
+	NOT_EXPORTED(time_type m_time)
+	NOT_EXPORTED(std::chrono::milliseconds m_offset)
+	bool m_resolved;
+};
+
+/**
+The result of an hourly weather import.
+ */
+struct REDAPP_EXPORT HourlyImport {
+	/*
+	The imported hours.
+	*/
+	WeatherSeries series;
+	/*
+	The result code from the import.
+	*/
+	long hr{ 0 };
+};
+
+/**
+Reads the hours from an hourly weather import a chunk at a time. Each chunk is removed from
+the Java side once it has been read, so only the unread hours stay in memory. The stream the
+reader came from may be modified or destroyed once the reader has been opened.
+ */
+class REDAPP_EXPORT HourlyReader {
+	friend class JavaWeatherStream;
+
+public:
+	HourlyReader(HourlyReader&& other) noexcept;
+	HourlyReader& operator=(HourlyReader&& other) noexcept;
+	HourlyReader(const HourlyReader&) = delete;
+	HourlyReader& operator=(const HourlyReader&) = delete;
+	~HourlyReader();
+
+	/**
+	The result code from the import.
+	 */
+	inline long result() const { return m_hr; }
+	/**
+	The number of hours that haven't been read yet.
+	 */
+	inline size_t remaining() const { return m_remaining; }
+	inline bool done() const { return m_remaining == 0; }
+
+	/**
+	Read up to capacity hours into buffer. Returns the number of hours read, 0 once every
+	hour has been read.
+	 */
+	size_t read(WeatherCollection* buffer, size_t capacity);
+	/**
+	Replace the contents of chunk with up to capacity hours. Returns the number of hours read,
+	0 once every hour has been read.
+	 */
+	size_t read(WeatherSeries& chunk, size_t capacity);
+	/**
+	Release any hours that haven't been read.
+	 */
+	void close();
+
+private:
+	HourlyReader(void* list, size_t size, long hr) : m_list(list), m_remaining(size), m_hr(hr) { }
+
+	/**
+	Read up to capacity hours into whichever of series or buffer isn't nullptr.
+	 */
+	size_t read(size_t capacity, WeatherSeries* series, WeatherCollection* buffer);
+
+	void* m_list{ nullptr };
+	size_t m_remaining{ 0 };
+	size_t m_offset{ 0 };
+	long m_hr{ 0 };
+	bool m_shrink{ true };
 };
 
 /**
@@ -286,9 +689,65 @@ public:
 		FIX = 2
 	};
 
+	/**
+	Which parser reads hourly weather files.
+	 */
+	enum class ImportParser {
+		/**
+		Always import through Java.
+		 */
+		JAVA = 0,
+		/**
+		Parse plain comma separated files natively and fall back to Java for anything the
+		native parser doesn't accept. The first file the native parser accepts in a process is
+		imported through Java as well, and if the two differ native parsing is turned off for
+		the rest of the process (ImportStatistics::nativeDisabled). Check the files you import
+		with the hourly_parser_conformance test before relying on it.
+		 */
+		NATIVE = 1,
+		/**
+		Parse with both and compare the results. The Java result is always the one returned,
+		differences are counted in the import statistics.
+		 */
+		VERIFY = 2
+	};
+
+	/**
+	Every setting of a stream, to apply with configure.
+	 */
+	struct StreamConfig {
+		double latitude{ 0.0 };
+		double longitude{ 0.0 };
+		int64_t timezone{ 0 };
+		int64_t daylightSavings{ 0 };
+		int64_t daylightSavingsStart{ 0 };
+		int64_t daylightSavingsEnd{ 0 };
+		InvalidHandler allowInvalid{ InvalidHandler::FAILURE };
+		ImportParser parser{ ImportParser::JAVA };
+	};
+
+	/**
+	One file to import with importHourlyMany and the stream settings to import it with.
+	 */
+	struct ImportSpec {
+		std::string filename;
+		StreamConfig config;
+	};
+
+	/**
+	The result of importing one file with importHourlyMany.
+	 */
+	struct ImportResult {
+		WeatherSeries series;
+		/*
+		The result code from the import.
+		 */
+		long hr{ 0 };
+	};
+
 public:
 	JavaWeatherStream();
-	JavaWeatherStream(void* internal, JavaClassDef type) : JavaObject(internal, type) { }
+	JavaWeatherStream(void* internal, JavaClassDef type) : JavaObject(internal, type), m_settingsKnown(false) { }
 
 	void setLatitude(double latitude);
 	void setLongitude(double longitude);
@@ -297,15 +756,63 @@ public:
 	void setDaylightSavingsStart(int64_t offset);
 	void setDaylightSavingsEnd(int64_t offset);
 	inline void setAllowInvalid(InvalidHandler allow) { m_allowInvalid = allow; }
+	/**
+	Choose which parser reads hourly weather files. Defaults to ImportParser::JAVA.
+	 */
+	inline void setImportParser(ImportParser parser) { m_parser = parser; }
+	/**
+	Apply every setting at once, in a single call into Java rather than one for each setter.
+	 */
+	void configure(const StreamConfig& config);
 
 	/**
 	Import hourly weather data. The returned list must be deleted by the caller if it is
 	not nullptr.
 	 */
 	WeatherCollection* importHourly(std::string& filename, long* hr, size_t* length);
+	/**
+	Import hourly weather data into a vector allocated from resource, or from the library wide
+	memory resource if it is nullptr.
+	 */
+	std::pmr::vector<WeatherCollection> importHourly(const std::string& filename, long* hr, std::pmr::memory_resource* resource = nullptr);
+	/**
+	Import hourly weather data directly into a columnar series. Any existing contents of
+	the series are replaced. Returns the result code from the import.
+	 */
+	long importHourly(const std::string& filename, WeatherSeries& series);
+	/**
+	Import hourly weather data and return a reader that copies the hours out a chunk at a
+	time instead of all at once.
+	 */
+	HourlyReader openHourly(const std::string& filename);
+	/**
+	Import several files at once, each with its own stream. The imports are spread across the
+	Java worker threads so set the worker count (REDappWrapper::SetWorkerCount) to the number of
+	files that should be read in parallel. The results are in the same order as specs. Called
+	from a worker thread, such as from a completion callback, or with ExecutionMode::DIRECT the
+	files are imported one after another on the calling thread.
+	 */
+	static std::vector<ImportResult> importHourlyMany(const std::vector<ImportSpec>& specs);
+	/**
+	Import hourly weather data on one of the Java worker threads. The stream must not be
+	destroyed or modified until the import has completed.
+	 */
+	std::future<HourlyImport> importHourlyAsync(const std::string& filename);
+	void importHourlyAsync(const std::string& filename, Completion<HourlyImport> callback);
+	Awaitable<HourlyImport> importHourlyAwait(const std::string& filename, Executor executor = nullptr);
 
 private:
+	HourlyImport importHourlyNow(std::string filename);
+
 	InvalidHandler m_allowInvalid{ InvalidHandler::FAILURE };
+	ImportParser m_parser{ ImportParser::JAVA };
+	int64_t m_timezone{ 0 };
+	int64_t m_daylightSavings{ 0 };
+	/**
+	Whether the timezone settings above match the Java object. They don't for streams
+	that wrap an existing Java object.
+	 */
+	bool m_settingsKnown{ true };
 };
 
 class REDAPP_EXPORT LocationWeather : public JavaObject {
@@ -330,11 +837,21 @@ public:
 	virtual size_t size() { return 0; }
 };
 
+/**
+The hours of a forecast copied out of Java.
+ */
+struct LocationHours;
+
 class REDAPP_EXPORT LocationWeatherGC : public LocationWeather {
 	friend class ForecastCalculator;
 
 public:
-	LocationWeatherGC(void* internal, JavaClassDef type) : LocationWeather(internal, type) { }
+	LocationWeatherGC(void* internal, JavaClassDef type);
+
+	/**
+	Valid if it wraps a Java forecast or holds hours copied from one, or from the forecast cache.
+	 */
+	bool isValid();
 
 	/**
 	Get a number of hours of data. data must be large enough to hold at least size hours of weather data.
@@ -343,6 +860,13 @@ public:
 	 */
 	virtual void getWeather(IWXData* data, size_t* size, size_t offset = 0);
 
+	/**
+	Get the times of a number of hours of data, in milliseconds since the epoch in GMT.
+	@param size The number of times to retrieve. If size is larger than the number of hours left to retrieve it will be updated to the number of times actually retrieved.
+	@param offset The number of hours to offset into the weather forecast.
+	 */
+	void getTimes(std::int64_t* times, size_t* size, size_t offset = 0);
+
 	/**
 	Get the start date of the weather information in GMT.
 	 */
@@ -352,6 +876,21 @@ public:
 	Gets the number of hours of data stored.
 	 */
 	virtual size_t size();
+
+private:
+	/**
+	A forecast that was found in the cache.
+	 */
+	explicit LocationWeatherGC(std::shared_ptr<LocationHours> hours);
+
+	/**
+	The forecast hours, copied out of Java the first time they are needed. The Java forecast is
+	released once they have been copied.
+	 */
+	const LocationHours& hours();
+
+private:
+	NOT_EXPORTED(std::shared_ptr<LocationHours> m_hours)
 };
 
 class REDAPP_EXPORT ForecastCalculator : public JavaObject {
@@ -359,8 +898,8 @@ public:
 	ForecastCalculator();
 	explicit ForecastCalculator(const std::string& stream);
 	ForecastCalculator(void* internal, JavaClassDef type) : JavaObject(internal, type), m_location(nullptr, JavaClassDef()) { m_model = Model::NCEP; m_timezone = 0; m_time = Time::NOON; m_hack50 = 50; }
-	ForecastCalculator(const ForecastCalculator& toCopy) : JavaObject(toCopy._internal, toCopy._type), m_location(nullptr, JavaClassDef()) { this->_internal = toCopy._internal; this->_type = toCopy._type; m_model = toCopy.m_model; m_location = toCopy.m_location; m_date = toCopy.m_date; m_timezone = toCopy.m_timezone; m_members = toCopy.m_members; m_date = toCopy.m_date; m_hack50 = 50; }
-	ForecastCalculator& operator=(const ForecastCalculator& toCopy) { if (&toCopy != this) { JavaObject::operator=(toCopy); m_model = toCopy.m_model; m_location = toCopy.m_location; m_date = toCopy.m_date; m_timezone = toCopy.m_timezone; m_members = toCopy.m_members; m_date = toCopy.m_date; } return *this; }
+	ForecastCalculator(const ForecastCalculator& toCopy) : JavaObject(toCopy), m_location(nullptr, JavaClassDef()) { m_model = toCopy.m_model; m_location = toCopy.m_location; m_date = toCopy.m_date; m_timezone = toCopy.m_timezone; m_members = toCopy.m_members; m_time = toCopy.m_time; m_hack50 = toCopy.m_hack50; }
+	ForecastCalculator& operator=(const ForecastCalculator& toCopy) { if (&toCopy != this) { JavaObject::operator=(toCopy); m_model = toCopy.m_model; m_location = toCopy.m_location; m_date = toCopy.m_date; m_timezone = toCopy.m_timezone; m_members = toCopy.m_members; m_time = toCopy.m_time; m_hack50 = toCopy.m_hack50; } return *this; }
 
 	inline void setLocation(const LocationSmall& loc) { m_location = loc; }
 	inline void setModel(REDapp::Model mod) { m_model = mod; }
@@ -375,8 +914,29 @@ public:
 	static void fromStreamable(std::string str);
 
 	std::vector<LocationSmall> getForecastCities(Province prov);
+	std::pmr::vector<LocationSmall> getForecastCities(Province prov, std::pmr::memory_resource* resource);
 
 	LocationWeatherGC getWeather(bool* success);
+	/**
+	Calculate the forecast for many locations with this calculator's model, date, time and
+	members. The locations are spread across the Java worker threads, each with a calculator
+	of its own. Called from a worker thread or with ExecutionMode::DIRECT the locations are
+	calculated one after another on the calling thread. The results are keyed by location name,
+	locations whose forecast failed are left out.
+	 */
+	std::map<std::string, LocationWeatherGC> getWeatherMany(const std::vector<LocationSmall>& locations);
+
+	/*
+	Queue the forecast on one of the Java worker threads. The calculator must not be destroyed
+	or modified until the forecast has completed. The returned weather is not valid if the
+	forecast failed.
+	 */
+	std::future<LocationWeatherGC> getWeatherAsync();
+	void getWeatherAsync(Completion<LocationWeatherGC> callback);
+	Awaitable<LocationWeatherGC> getWeatherAwait(Executor executor = nullptr);
+	std::future<std::vector<LocationSmall>> getForecastCitiesAsync(Province prov);
+	void getForecastCitiesAsync(Province prov, Completion<std::vector<LocationSmall>> callback);
+	Awaitable<std::vector<LocationSmall>> getForecastCitiesAwait(Province prov, Executor executor = nullptr);
 
 	static inline bool isStreamable(const std::string& stream) { return !stream.compare(0, 7, std::string("ACHERON")); }
 
@@ -390,6 +950,163 @@ private:
 	NOT_EXPORTED(std::vector<int> m_members)
 };
 
+/**
+How calls into Java are executed.
+ */
+enum class REDAPP_EXPORT ExecutionMode : short int {
+	/*
+	Calls are handed to a worker thread that owns the connection to Java.
+	*/
+	WORKER,
+	/*
+	Calls are made on the calling thread, which is attached to Java the first time it
+	calls in. Saves two thread switches per call.
+	*/
+	DIRECT
+};
+
+/**
+Counters describing the queue of work waiting for the Java worker thread.
+ */
+struct REDAPP_EXPORT WorkerStatistics {
+	/*
+	The number of worker threads attached to Java.
+	*/
+	std::uint64_t workers;
+	/*
+	The number of jobs the worker has completed.
+	*/
+	std::uint64_t jobs;
+	/*
+	The number of jobs currently waiting to run.
+	*/
+	std::uint64_t queueDepth;
+	/*
+	The largest number of jobs that have been waiting at once.
+	*/
+	std::uint64_t maxQueueDepth;
+	/*
+	The total time jobs have spent waiting in the queue before starting.
+	*/
+	std::uint64_t totalWaitNanoseconds;
+	/*
+	The longest time a single job has waited in the queue.
+	*/
+	std::uint64_t maxWaitNanoseconds;
+	/*
+	The number of times a caller found the queue full and had to wait for space.
+	*/
+	std::uint64_t queueFullWaits;
+	/*
+	The number of jobs that were taken from a busy worker by an idle one.
+	*/
+	std::uint64_t steals;
+};
+
+/**
+Counters for the cache of classes, methods and fields looked up from Java. Each miss is one
+lookup in Java.
+ */
+struct REDAPP_EXPORT CacheStatistics {
+	std::uint64_t classHits;
+	std::uint64_t classMisses;
+	std::uint64_t methodHits;
+	std::uint64_t methodMisses;
+	std::uint64_t fieldHits;
+	std::uint64_t fieldMisses;
+};
+
+/**
+Counters for hourly imports made with the native parser enabled.
+ */
+struct REDAPP_EXPORT ImportStatistics {
+	/*
+	Imports read by the native parser.
+	 */
+	std::uint64_t nativeImports;
+	/*
+	Imports the native parser didn't accept that were read by Java instead.
+	 */
+	std::uint64_t javaFallbacks;
+	/*
+	Imports in ImportParser::VERIFY mode where both parsers accepted the file.
+	 */
+	std::uint64_t verified;
+	/*
+	Verified imports where the native result differed from the Java one.
+	 */
+	std::uint64_t mismatches;
+	/*
+	Whether ImportParser::NATIVE has been turned off because its first checked import
+	didn't match Java.
+	 */
+	bool nativeDisabled;
+};
+
+/**
+Counters for spline interpolations made with the native engine enabled.
+ */
+struct REDAPP_EXPORT SplineStatistics {
+	/*
+	Interpolations computed by the native spline.
+	 */
+	std::uint64_t nativeFits;
+	/*
+	Interpolations the native spline didn't accept that were computed by Java instead.
+	 */
+	std::uint64_t javaFallbacks;
+	/*
+	Interpolations in SplineEngine::VERIFY mode that were computed by both.
+	 */
+	std::uint64_t verified;
+	/*
+	Verified interpolations where a native value differed from the Java one by more than
+	the tolerance.
+	 */
+	std::uint64_t mismatches;
+};
+
+/**
+Settings for the cache of calculated forecasts.
+ */
+struct REDAPP_EXPORT ForecastCacheOptions {
+	/*
+	How long a calculated forecast is reused for. Zero turns the cache off.
+	 */
+	std::chrono::seconds ttl{ 0 };
+	/*
+	The number of forecasts kept in memory. The least recently used are dropped first.
+	 */
+	size_t capacity{ 64 };
+	/*
+	A directory to also keep forecasts in so they survive a restart. Empty to only keep
+	them in memory.
+	 */
+	NOT_EXPORTED(std::string directory)
+};
+
+/**
+Counters for the cache of calculated forecasts.
+ */
+struct REDAPP_EXPORT ForecastCacheStatistics {
+	/*
+	Forecasts found in memory.
+	 */
+	std::uint64_t memoryHits;
+	/*
+	Forecasts read back from the cache directory.
+	 */
+	std::uint64_t diskHits;
+	/*
+	Forecasts that had to be calculated.
+	 */
+	std::uint64_t misses;
+	/*
+	Forecasts dropped from memory to make room for newer ones.
+	 */
+	std::uint64_t evictions;
+};
+
 /**
 The wrapper class for the main Java calls to REDapp.
  */
@@ -406,6 +1123,77 @@ public:
 	static std::string GetDetailedError();
 	static std::string GetJavaPath();
 	static std::string GetJavaVersion();
+	/*
+	Get the number of times work has been handed to the Java worker thread. Useful
+	for measuring how many thread switches a call costs.
+	 */
+	static std::uint64_t JavaHopCount();
+	/*
+	Get counters for the queue of work waiting for the Java worker thread.
+	 */
+	static WorkerStatistics GetWorkerStatistics();
+	/*
+	Get the hit and miss counters for the cache of classes, methods and fields.
+	 */
+	static CacheStatistics GetCacheStatistics();
+	/*
+	Get the counters for imports made with the native hourly parser enabled.
+	 */
+	static ImportStatistics GetImportStatistics();
+	/*
+	Get the counters for interpolations made with the native spline enabled.
+	 */
+	static SplineStatistics GetSplineStatistics();
+	/*
+	Turn on, off or resize the cache of calculated forecasts. Forecasts are cached by location
+	name and province, model, date, time, members and percentile. Only locations fetched with
+	ForecastCalculator::getForecastCities know their province, forecasts for other locations
+	aren't cached. Off by default.
+	 */
+	static void SetForecastCache(const ForecastCacheOptions& options);
+	static ForecastCacheOptions GetForecastCache();
+	/*
+	Remove every cached forecast, including any written to the cache directory.
+	 */
+	static void ClearForecastCache();
+	/*
+	Get the hit and miss counters for the cache of calculated forecasts.
+	 */
+	static ForecastCacheStatistics GetForecastCacheStatistics();
+
+	/*
+	Set the number of threads that make calls into Java. Independent imports and forecasts
+	are spread across the threads. Must be called before Java is loaded, later calls only
+	take effect if Java is reinitialized. Defaults to 1.
+	 */
+	static void SetWorkerCount(size_t count);
+	static size_t GetWorkerCount();
+
+	/*
+	Choose whether calls into Java are handed to the worker threads or made directly on the
+	calling thread. Should be set before objects are shared between threads. Defaults to
+	ExecutionMode::WORKER.
+	 */
+	static void SetExecutionMode(ExecutionMode mode);
+	static ExecutionMode GetExecutionMode();
+
+	/*
+	Choose whether imported weather is copied out of Java in bulk, and Java spline input and
+	output passed as primitive arrays, when REDappWrapperAdapter.jar is installed beside the
+	REDapp jars. Without the jar, or with bulk transfers turned off, weather is read one field
+	at a time and splines go through a HourValue object per point. Defaults to true.
+	 */
+	static void SetBulkTransfers(bool enabled);
+	static bool GetBulkTransfers();
+
+	/*
+	Set the memory resource used for results and marshalling buffers when a call isn't given
+	one explicitly. nullptr restores the default resource. Allocations can be made from the
+	Java worker threads, so the resource must be safe to use from any thread that is making
+	calls at the same time.
+	 */
+	static void SetMemoryResource(std::pmr::memory_resource* resource);
+	static std::pmr::memory_resource* GetMemoryResource();
 
 	static bool InternetDetected();
 
@@ -415,10 +1203,19 @@ public:
 	  Fetch the cities in a given province that weatheroffice.gc.ca has current weather data for.
 	 */
 	std::vector<Cities> getCities(Province prov);
+	std::pmr::vector<Cities> getCities(Province prov, std::pmr::memory_resource* resource);
 	/*
 	Get the current weather for the given city from weatheroffice.gc.ca.
 	 */
 	GCWeather getGCWeather(Cities city);
+	/*
+	Fetch cities or current weather on one of the Java worker threads.
+	 */
+	std::future<std::vector<Cities>> getCitiesAsync(Province prov);
+	void getCitiesAsync(Province prov, Completion<std::vector<Cities>> callback);
+	Awaitable<std::vector<Cities>> getCitiesAwait(Province prov, Executor executor = nullptr);
+	std::future<GCWeather> getGCWeatherAsync(Cities city);
+	void getGCWeatherAsync(Cities city, Completion<GCWeather> callback);
 	void getGCForecast(LocationSmall loc);
 
 private:
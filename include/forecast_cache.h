@@ -0,0 +1,105 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: forecast_cache.h
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+#include "ICWFGM_Weather.h"
+#include "REDappWrapper.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * The hours of a calculated forecast, as copied out of Java.
+ */
+struct ForecastHours {
+	std::vector<IWXData> hours;
+	/**
+	 * The time of each hour in milliseconds since the epoch.
+	 */
+	std::vector<std::int64_t> times;
+};
+
+/**
+ * A cache of calculated forecasts keyed by the parameters that produced them. Forecasts are kept
+ * in memory up to a fixed count, least recently used first out, and optionally written to a
+ * directory so they survive a restart. Entries older than the time to live are calculated again.
+ */
+class ForecastCache {
+public:
+	typedef std::chrono::system_clock clock;
+
+	/**
+	 * Replace the cache settings. Forecasts already in memory are kept unless they no longer fit.
+	 */
+	void configure(const REDapp::ForecastCacheOptions& options);
+	REDapp::ForecastCacheOptions options();
+	/**
+	 * Is the cache turned on at all.
+	 */
+	inline bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+	/**
+	 * Find a forecast that hasn't expired, checking memory first and then the directory.
+	 */
+	std::shared_ptr<const ForecastHours> find(const std::string& key);
+	/**
+	 * Add a newly calculated forecast.
+	 */
+	void insert(const std::string& key, std::shared_ptr<const ForecastHours> hours);
+	/**
+	 * Remove every cached forecast, including those written to the directory.
+	 */
+	void clear();
+
+	REDapp::ForecastCacheStatistics statistics();
+
+private:
+	struct entry {
+		std::string key;
+		clock::time_point created;
+		std::shared_ptr<const ForecastHours> hours;
+	};
+
+	bool expired(clock::time_point created, clock::time_point now) const;
+	void insertLocked(entry&& e);
+	std::string filename(const std::string& key) const;
+	std::shared_ptr<const ForecastHours> read(const std::string& key, clock::time_point& created);
+	void write(const std::string& key, clock::time_point created, const ForecastHours& hours);
+
+private:
+	std::mutex m_lock;
+	std::atomic<bool> m_enabled{ false };
+	REDapp::ForecastCacheOptions m_options;
+	std::list<entry> m_entries;
+	std::unordered_map<std::string, std::list<entry>::iterator> m_index;
+
+	std::atomic<std::uint64_t> m_memoryHits{ 0 };
+	std::atomic<std::uint64_t> m_diskHits{ 0 };
+	std::atomic<std::uint64_t> m_misses{ 0 };
+	std::atomic<std::uint64_t> m_evictions{ 0 };
+};
@@ -0,0 +1,71 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: hourly_parser.h
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+#include "ICWFGM_Weather.h"
+#include "REDappWrapper.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+
+/**
+ * A native parser for the plain comma separated hourly weather files that make up most imports.
+ *
+ * The parser is deliberately strict. It only accepts files where every value is in range and the
+ * hours are consecutive, so that it never has to decide how invalid data should be handled. Anything
+ * else is rejected and left to the Java importer, which applies the stream's InvalidHandler and
+ * reports the matching result code.
+ *
+ * Accepted files have a header row naming the columns, in any order and case:
+ *   HOURLY or DATE    the date as yyyy-mm-dd
+ *   HOUR              the hour of the day, 0 to 23
+ *   TEMP, RH, WD, WS  temperature, relative humidity, wind direction and speed
+ *   PRECIP or RAIN    precipitation
+ *   WG or GUST        optional wind gust
+ */
+namespace HourlyParser {
+	/**
+	 * The stream settings that affect the parsed values.
+	 */
+	struct Settings {
+		/**
+		 * The offset from UTC of the times in the file, in seconds.
+		 */
+		std::int64_t timezone{ 0 };
+		/**
+		 * The amount of daylight savings applied to the file, in seconds. Files with daylight
+		 * savings are left to Java.
+		 */
+		std::int64_t daylightSavings{ 0 };
+	};
+
+	/**
+	 * Parse a file that is already in memory. Returns false without keeping any parsed hours if
+	 * the data isn't in a form the parser accepts.
+	 */
+	bool parse(const char* data, std::size_t size, const Settings& settings, WeatherSeries& out);
+	/**
+	 * Map a file into memory and parse it. Returns false if the file can't be opened or isn't in
+	 * a form the parser accepts.
+	 */
+	bool parseFile(const std::string& filename, const Settings& settings, WeatherSeries& out);
+}
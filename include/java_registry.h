@@ -0,0 +1,301 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: java_registry.h
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "java_types.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * Every Java class the wrapper uses.
+ *
+ * X(id, class name, optional)
+ */
+#define REDAPP_JAVA_CLASSES(X) \
+	X(Calculator, "ca/weather/acheron/Calculator", false) \
+	X(LocationSmall, "ca/weather/acheron/Calculator$LocationSmall", false) \
+	X(LocationWeather, "ca/weather/acheron/LocationWeather", false) \
+	X(Hour, "ca/weather/acheron/Hour", false) \
+	X(Interpolator, "ca/weather/acheron/Interpolator", false) \
+	X(HourValue, "ca/weather/acheron/Interpolator$HourValue", false) \
+	X(Cities, "ca/weather/current/Cities/Cities", false) \
+	X(CitiesHelper, "ca/weather/current/Cities/CitiesHelper", false) \
+	X(CurrentWeather, "ca/weather/current/CurrentWeather", false) \
+	X(Model, "ca/weather/forecast/Model", false) \
+	X(Time, "ca/weather/forecast/Time", false) \
+	X(Province, "ca/weather/forecast/Province", false) \
+	X(SpotWXModel, "ca/weather/forecast/SpotWXModel", true) \
+	X(WebDownloader, "ca/hss/general/WebDownloader", false) \
+	X(OutVariable, "ca/hss/general/OutVariable", false) \
+	X(WorldLocation, "ca/hss/times/WorldLocation", false) \
+	X(WeatherCondition, "ca/wise/weather/WeatherCondition", false) \
+	X(WeatherCollection, "ca/wise/weather/WeatherCondition$WeatherCollection", false) \
+	X(Calendar, "java/util/Calendar", false) \
+	X(TimeZone, "java/util/TimeZone", false) \
+	X(SimpleDateFormat, "java/text/SimpleDateFormat", false) \
+	X(List, "java/util/List", false) \
+	X(Long, "java/lang/Long", false) \
+	X(Double, "java/lang/Double", false) \
+	X(BulkTransfer, "ca/wise/redapp/BulkTransfer", true)
+
+/**
+ * Every method and field the wrapper uses.
+ *
+ * X(id, class id, kind, member name, signature, optional)
+ *
+ * CONSTANT members are static object fields, normally Java enum constants, whose value is
+ * looked up and pinned along with the IDs.
+ */
+#define REDAPP_JAVA_MEMBERS(X) \
+	X(Calculator_init, Calculator, METHOD, "<init>", "()V", false) \
+	X(Calculator_getLocations, Calculator, STATIC_METHOD, "getLocations", "()Ljava/util/List;", false) \
+	X(Calculator_getProvinceLocations, Calculator, STATIC_METHOD, "getLocations", "(Lca/weather/forecast/Province;)Ljava/util/List;", false) \
+	X(Calculator_setLocation, Calculator, METHOD, "setLocation", "(Ljava/lang/String;)V", false) \
+	X(Calculator_setModel, Calculator, METHOD, "setModel", "(Lca/weather/forecast/Model;)V", false) \
+	X(Calculator_setTime, Calculator, METHOD, "setTime", "(Lca/weather/forecast/Time;)V", false) \
+	X(Calculator_clearMembers, Calculator, METHOD, "clearMembers", "()V", false) \
+	X(Calculator_addMember, Calculator, METHOD, "addMember", "(I)V", false) \
+	X(Calculator_setTimezone, Calculator, METHOD, "setTimezone", "(Lca/hss/times/TimeZoneInfo;)V", false) \
+	X(Calculator_setDate, Calculator, METHOD, "setDate", "(Ljava/util/Calendar;)V", false) \
+	X(Calculator_setPercentile, Calculator, METHOD, "setPercentile", "(I)V", false) \
+	X(Calculator_calculate, Calculator, METHOD, "calculate", "()Z", false) \
+	X(Calculator_getLocationsWeatherData, Calculator, METHOD, "getLocationsWeatherData", "(I)Lca/weather/acheron/LocationWeather;", false) \
+	X(LocationSmall_locationName, LocationSmall, FIELD, "locationName", "Ljava/lang/String;", false) \
+	X(LocationWeather_getHourData, LocationWeather, METHOD, "getHourData", "()Ljava/util/List;", false) \
+	X(Hour_getTemperature, Hour, METHOD, "getTemperature", "()D", false) \
+	X(Hour_getRelativeHumidity, Hour, METHOD, "getRelativeHumidity", "()D", false) \
+	X(Hour_getPrecipitation, Hour, METHOD, "getPrecipitation", "()D", false) \
+	X(Hour_getWindSpeed, Hour, METHOD, "getWindSpeed", "()D", false) \
+	X(Hour_getWindDirection, Hour, METHOD, "getWindDirection", "()D", false) \
+	X(Hour_isInterpolated, Hour, METHOD, "isInterpolated", "()Z", false) \
+	X(Hour_getCalendarDate, Hour, METHOD, "getCalendarDate", "()Ljava/util/Calendar;", false) \
+	X(Interpolator_init, Interpolator, METHOD, "<init>", "()V", false) \
+	X(Interpolator_splineInterpolate, Interpolator, METHOD, "splineInterpolate", "([Lca/weather/acheron/Interpolator$HourValue;)[Lca/weather/acheron/Interpolator$HourValue;", false) \
+	X(HourValue_init, HourValue, METHOD, "<init>", "()V", false) \
+	X(HourValue_houroffset, HourValue, FIELD, "houroffset", "D", false) \
+	X(HourValue_value, HourValue, FIELD, "value", "D", false) \
+	X(Cities_getName, Cities, METHOD, "getName", "()Ljava/lang/String;", false) \
+	X(CitiesHelper_getCities, CitiesHelper, STATIC_METHOD, "getCities", "(Lca/weather/forecast/Province;)[Lca/weather/current/Cities/Cities;", false) \
+	X(CurrentWeather_init, CurrentWeather, METHOD, "<init>", "(Lca/weather/current/Cities/Cities;)V", false) \
+	X(CurrentWeather_getObserved, CurrentWeather, METHOD, "getObserved", "()Ljava/lang/String;", false) \
+	X(CurrentWeather_getTemperature, CurrentWeather, METHOD, "getTemperature", "()Ljava/lang/Double;", false) \
+	X(CurrentWeather_getPressure, CurrentWeather, METHOD, "getPressure", "()Ljava/lang/Double;", false) \
+	X(CurrentWeather_getVisibility, CurrentWeather, METHOD, "getVisibility", "()Ljava/lang/Double;", false) \
+	X(CurrentWeather_getHumidity, CurrentWeather, METHOD, "getHumidity", "()Ljava/lang/Double;", false) \
+	X(CurrentWeather_getWindchill, CurrentWeather, METHOD, "getWindchill", "()Ljava/lang/Double;", false) \
+	X(CurrentWeather_getDewpoint, CurrentWeather, METHOD, "getDewpoint", "()Ljava/lang/Double;", false) \
+	X(CurrentWeather_getWindDirection, CurrentWeather, METHOD, "getWindDirection", "()Ljava/lang/String;", false) \
+	X(CurrentWeather_getWindSpeed, CurrentWeather, METHOD, "getWindSpeed", "()Ljava/lang/Double;", false) \
+	X(Model_GEM_DETER, Model, CONSTANT, "GEM_DETER", "Lca/weather/forecast/Model;", false) \
+	X(Model_NCEP, Model, CONSTANT, "NCEP", "Lca/weather/forecast/Model;", false) \
+	X(Model_GEM, Model, CONSTANT, "GEM", "Lca/weather/forecast/Model;", false) \
+	X(Model_BOTH, Model, CONSTANT, "BOTH", "Lca/weather/forecast/Model;", false) \
+	X(Model_CUSTOM, Model, CONSTANT, "CUSTOM", "Lca/weather/forecast/Model;", false) \
+	X(Time_MIDNIGHT, Time, CONSTANT, "MIDNIGHT", "Lca/weather/forecast/Time;", false) \
+	X(Time_NOON, Time, CONSTANT, "NOON", "Lca/weather/forecast/Time;", false) \
+	X(Province_ALBERTA, Province, CONSTANT, "ALBERTA", "Lca/weather/forecast/Province;", false) \
+	X(Province_BRITISH_COLUMBIA, Province, CONSTANT, "BRITISH_COLUMBIA", "Lca/weather/forecast/Province;", false) \
+	X(Province_MANITOBA, Province, CONSTANT, "MANITOBA", "Lca/weather/forecast/Province;", false) \
+	X(Province_NEW_BRUNSWICK, Province, CONSTANT, "NEW_BRUNSWICK", "Lca/weather/forecast/Province;", false) \
+	X(Province_NEWFOUNDLAND_AND_LABRADOR, Province, CONSTANT, "NEWFOUNDLAND_AND_LABRADOR", "Lca/weather/forecast/Province;", false) \
+	X(Province_NORTHWEST_TERRITORIES, Province, CONSTANT, "NORTHWEST_TERRITORIES", "Lca/weather/forecast/Province;", false) \
+	X(Province_NOVA_SCOTIA, Province, CONSTANT, "NOVA_SCOTIA", "Lca/weather/forecast/Province;", false) \
+	X(Province_NUNAVUT, Province, CONSTANT, "NUNAVUT", "Lca/weather/forecast/Province;", false) \
+	X(Province_ONTARIO, Province, CONSTANT, "ONTARIO", "Lca/weather/forecast/Province;", false) \
+	X(Province_PRINCE_EDWARD_ISLAND, Province, CONSTANT, "PRINCE_EDWARD_ISLAND", "Lca/weather/forecast/Province;", false) \
+	X(Province_QUEBEC, Province, CONSTANT, "QUEBEC", "Lca/weather/forecast/Province;", false) \
+	X(Province_SASKATCHEWAN, Province, CONSTANT, "SASKATCHEWAN", "Lca/weather/forecast/Province;", false) \
+	X(Province_YUKON, Province, CONSTANT, "YUKON", "Lca/weather/forecast/Province;", false) \
+	X(SpotWXModel_HRDPS_CONTINENTAL, SpotWXModel, CONSTANT, "HRDPS_CONTINENTAL", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_HRDPS_WEST, SpotWXModel, CONSTANT, "HRDPS_WEST", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_HRDPS_PRAIRIES, SpotWXModel, CONSTANT, "HRDPS_PRAIRIES", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_HRDPS_EAST, SpotWXModel, CONSTANT, "HRDPS_EAST", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_HRDPS_MARITIMES, SpotWXModel, CONSTANT, "HRDPS_MARITIMES", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_HRDPS_ARCTIC, SpotWXModel, CONSTANT, "HRDPS_ARCTIC", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_HRDPS_LANCASTER, SpotWXModel, CONSTANT, "HRDPS_LANCASTER", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_RDPS, SpotWXModel, CONSTANT, "RDPS", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_GDPS, SpotWXModel, CONSTANT, "GDPS", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_NAM, SpotWXModel, CONSTANT, "NAM", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_GFS, SpotWXModel, CONSTANT, "GFS", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_HRRR, SpotWXModel, CONSTANT, "HRRR", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_RAP, SpotWXModel, CONSTANT, "RAP", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(SpotWXModel_GEPS, SpotWXModel, CONSTANT, "GEPS", "Lca/weather/forecast/SpotWXModel;", true) \
+	X(WebDownloader_hasInternetConnection, WebDownloader, STATIC_METHOD, "hasInternetConnection", "()Z", false) \
+	X(OutVariable_init, OutVariable, METHOD, "<init>", "()V", false) \
+	X(OutVariable_value, OutVariable, FIELD, "value", "Ljava/lang/Object;", false) \
+	X(WorldLocation_getTimeZoneFromOffset, WorldLocation, STATIC_METHOD, "getTimeZoneFromOffset", "(I)Lca/hss/times/TimeZoneInfo;", false) \
+	X(WeatherCondition_init, WeatherCondition, METHOD, "<init>", "()V", false) \
+	X(WeatherCondition_setLatitude, WeatherCondition, METHOD, "setLatitude", "(D)V", false) \
+	X(WeatherCondition_setLongitude, WeatherCondition, METHOD, "setLongitude", "(D)V", false) \
+	X(WeatherCondition_setTimezone, WeatherCondition, METHOD, "setTimezone", "(J)V", false) \
+	X(WeatherCondition_setDaylightSavings, WeatherCondition, METHOD, "setDaylightSavings", "(J)V", false) \
+	X(WeatherCondition_setDaylightSavingsStart, WeatherCondition, METHOD, "setDaylightSavingsStart", "(J)V", false) \
+	X(WeatherCondition_setDaylightSavingsEnd, WeatherCondition, METHOD, "setDaylightSavingsEnd", "(J)V", false) \
+	X(WeatherCondition_importHourly, WeatherCondition, METHOD, "importHourly", \
+		JMethodDefinition(JParameter(JTypeString) JObjectParameter(ca/hss/general/OutVariable) JTypeInt, JObjectParameter(java/util/List)), true) \
+	X(WeatherCondition_importHourlyLegacy, WeatherCondition, METHOD, "importHourly", \
+		JMethodDefinition(JParameter(JTypeString) JObjectParameter(ca/hss/general/OutVariable), JObjectParameter(java/util/List)), true) \
+	X(WeatherCollection_hour, WeatherCollection, FIELD, "hour", "D", false) \
+	X(WeatherCollection_epoch, WeatherCollection, FIELD, "epoch", "J", false) \
+	X(WeatherCollection_temp, WeatherCollection, FIELD, "temp", "D", false) \
+	X(WeatherCollection_rh, WeatherCollection, FIELD, "rh", "D", false) \
+	X(WeatherCollection_wd, WeatherCollection, FIELD, "wd", "D", false) \
+	X(WeatherCollection_ws, WeatherCollection, FIELD, "ws", "D", false) \
+	X(WeatherCollection_wg, WeatherCollection, FIELD, "wg", "D", false) \
+	X(WeatherCollection_precip, WeatherCollection, FIELD, "precip", "D", false) \
+	X(WeatherCollection_ffmc, WeatherCollection, FIELD, "ffmc", "D", false) \
+	X(WeatherCollection_DMC, WeatherCollection, FIELD, "DMC", "D", false) \
+	X(WeatherCollection_DC, WeatherCollection, FIELD, "DC", "D", false) \
+	X(WeatherCollection_BUI, WeatherCollection, FIELD, "BUI", "D", false) \
+	X(WeatherCollection_ISI, WeatherCollection, FIELD, "ISI", "D", false) \
+	X(WeatherCollection_FWI, WeatherCollection, FIELD, "FWI", "D", false) \
+	X(WeatherCollection_options, WeatherCollection, FIELD, "options", "I", false) \
+	X(Calendar_getInstance, Calendar, STATIC_METHOD, "getInstance", "()Ljava/util/Calendar;", false) \
+	X(Calendar_get, Calendar, METHOD, "get", "(I)I", false) \
+	X(Calendar_setTimeZone, Calendar, METHOD, "setTimeZone", "(Ljava/util/TimeZone;)V", false) \
+	X(Calendar_setTime, Calendar, METHOD, "setTime", "(Ljava/util/Date;)V", false) \
+	X(Calendar_getTimeInMillis, Calendar, METHOD, "getTimeInMillis", "()J", false) \
+	X(Calendar_setTimeInMillis, Calendar, METHOD, "setTimeInMillis", "(J)V", false) \
+	X(TimeZone_getTimeZone, TimeZone, STATIC_METHOD, "getTimeZone", "(Ljava/lang/String;)Ljava/util/TimeZone;", false) \
+	X(SimpleDateFormat_init, SimpleDateFormat, METHOD, "<init>", "(Ljava/lang/String;)V", false) \
+	X(SimpleDateFormat_parse, SimpleDateFormat, METHOD, "parse", "(Ljava/lang/String;)Ljava/util/Date;", false) \
+	X(List_size, List, METHOD, "size", "()I", false) \
+	X(List_get, List, METHOD, "get", "(I)Ljava/lang/Object;", false) \
+	X(List_subList, List, METHOD, "subList", "(II)Ljava/util/List;", false) \
+	X(List_clear, List, METHOD, "clear", "()V", false) \
+	X(Long_init, Long, METHOD, "<init>", "(J)V", false) \
+	X(Long_longValue, Long, METHOD, "longValue", "()J", false) \
+	X(Double_doubleValue, Double, METHOD, "doubleValue", "()D", false) \
+	X(BulkTransfer_weatherColumns, BulkTransfer, STATIC_METHOD, "weatherColumns", "(Ljava/util/List;[D[J[I)Z", true) \
+	X(BulkTransfer_splineInterpolate, BulkTransfer, STATIC_METHOD, "splineInterpolate", "(Ljava/lang/Object;[D[D)[[D", true)
+
+
+namespace JavaRegistry {
+#define REDAPP_JAVA_ENUM_ENTRY(id, ...) id,
+
+	/**
+	 * An index into the table of classes.
+	 */
+	enum class Class : std::uint16_t {
+		REDAPP_JAVA_CLASSES(REDAPP_JAVA_ENUM_ENTRY)
+		COUNT
+	};
+
+	/**
+	 * An index into the table of methods and fields.
+	 */
+	enum class Member : std::uint16_t {
+		REDAPP_JAVA_MEMBERS(REDAPP_JAVA_ENUM_ENTRY)
+		COUNT
+	};
+
+#undef REDAPP_JAVA_ENUM_ENTRY
+
+	enum class MemberKind : std::uint8_t {
+		METHOD,
+		STATIC_METHOD,
+		FIELD,
+		STATIC_FIELD,
+		CONSTANT
+	};
+
+	struct ClassEntry {
+		const char* name;
+		bool optional;
+	};
+
+	struct MemberEntry {
+		Class cls;
+		MemberKind kind;
+		const char* name;
+		const char* signature;
+		bool optional;
+	};
+
+	inline constexpr std::size_t ClassCount = (std::size_t)Class::COUNT;
+	inline constexpr std::size_t MemberCount = (std::size_t)Member::COUNT;
+
+	inline constexpr ClassEntry Classes[ClassCount] = {
+#define REDAPP_JAVA_CLASS_ENTRY(id, name, optional) { name, optional },
+		REDAPP_JAVA_CLASSES(REDAPP_JAVA_CLASS_ENTRY)
+#undef REDAPP_JAVA_CLASS_ENTRY
+	};
+
+	inline constexpr MemberEntry Members[MemberCount] = {
+#define REDAPP_JAVA_MEMBER_ENTRY(id, cls, kind, name, signature, optional) { Class::cls, MemberKind::kind, name, signature, optional },
+		REDAPP_JAVA_MEMBERS(REDAPP_JAVA_MEMBER_ENTRY)
+#undef REDAPP_JAVA_MEMBER_ENTRY
+	};
+
+	/**
+	 * The Java constant for each value of the matching native enum, in native enum order so the
+	 * native value can be used as the index.
+	 */
+	inline constexpr Member ProvinceConstants[] = {
+		Member::Province_ALBERTA,
+		Member::Province_BRITISH_COLUMBIA,
+		Member::Province_MANITOBA,
+		Member::Province_NEW_BRUNSWICK,
+		Member::Province_NEWFOUNDLAND_AND_LABRADOR,
+		Member::Province_NORTHWEST_TERRITORIES,
+		Member::Province_NOVA_SCOTIA,
+		Member::Province_NUNAVUT,
+		Member::Province_ONTARIO,
+		Member::Province_PRINCE_EDWARD_ISLAND,
+		Member::Province_QUEBEC,
+		Member::Province_SASKATCHEWAN,
+		Member::Province_YUKON
+	};
+
+	inline constexpr Member ModelConstants[] = {
+		Member::Model_GEM_DETER,
+		Member::Model_NCEP,
+		Member::Model_GEM,
+		Member::Model_BOTH,
+		Member::Model_CUSTOM
+	};
+
+	/**
+	 * Nothing converts a SpotWX model yet, the constants are pinned so one can be added without
+	 * touching the registry. Optional so older REDapp libraries without them still load.
+	 */
+	inline constexpr Member SpotWXModelConstants[] = {
+		Member::SpotWXModel_HRDPS_CONTINENTAL,
+		Member::SpotWXModel_HRDPS_WEST,
+		Member::SpotWXModel_HRDPS_PRAIRIES,
+		Member::SpotWXModel_HRDPS_EAST,
+		Member::SpotWXModel_HRDPS_MARITIMES,
+		Member::SpotWXModel_HRDPS_ARCTIC,
+		Member::SpotWXModel_HRDPS_LANCASTER,
+		Member::SpotWXModel_RDPS,
+		Member::SpotWXModel_GDPS,
+		Member::SpotWXModel_NAM,
+		Member::SpotWXModel_GFS,
+		Member::SpotWXModel_HRRR,
+		Member::SpotWXModel_RAP,
+		Member::SpotWXModel_GEPS
+	};
+
+	inline constexpr Member TimeConstants[] = {
+		Member::Time_MIDNIGHT,
+		Member::Time_NOON
+	};
+}
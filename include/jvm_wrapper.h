@@ -57,20 +57,39 @@ public:
 	inline std::string GetJavaVersion() { return javaVersion; }
 	inline std::string GetDetailedError() { return detailedError; }
 
-	virtual jclass FindClass(const std::string& signature) = 0;
-	virtual jfieldID GetStaticFieldID(jclass clz, const std::string& name, const std::string& signature) = 0;
+	/**
+	 * Attach the calling thread to the JVM so that it has its own JNIEnv. The thread that
+	 * created the JVM is attached automatically. Does nothing if the thread is already attached.
+	 */
+	virtual bool AttachCurrentThread() = 0;
+	/**
+	 * Attach the calling thread to the JVM as a daemon thread so it won't keep the JVM alive.
+	 * The thread is detached automatically when it exits. Does nothing if the thread is already
+	 * attached.
+	 */
+	virtual bool AttachCurrentThreadAsDaemon() = 0;
+	/**
+	 * Detach the calling thread from the JVM. Any local references it holds become invalid.
+	 */
+	virtual void DetachCurrentThread() = 0;
+
+	virtual jclass FindClass(const char* signature) = 0;
+	virtual jfieldID GetStaticFieldID(jclass clz, const char* name, const char* signature) = 0;
 	virtual jobject GetStaticObjectField(jclass clz, jfieldID fld) = 0;
-	virtual jmethodID GetMethodID(jclass clz, const std::string& name, const std::string& signature) = 0;
-	virtual jmethodID GetStaticMethodID(jclass clz, const std::string& name, const std::string& signature) = 0;
-	virtual jfieldID GetFieldID(jclass clz, const std::string& name, const std::string& signature) = 0;
+	virtual jmethodID GetMethodID(jclass clz, const char* name, const char* signature) = 0;
+	virtual jmethodID GetStaticMethodID(jclass clz, const char* name, const char* signature) = 0;
+	virtual jfieldID GetFieldID(jclass clz, const char* name, const char* signature) = 0;
 
 	virtual jobject CallStaticObjectMethod(jclass cls, jmethodID mid, jobject param) = 0;
+	virtual jobject CallStaticObjectMethodOOO(jclass cls, jmethodID mid, jobject o1, jobject o2, jobject o3) = 0;
 	virtual jobject CallStaticObjectMethod(jclass cls, jmethodID mid, jint param) = 0;
 	virtual jboolean CallStaticBooleanMethod(jclass cls, jmethodID mid, jobject param) = 0;
+	virtual jboolean CallStaticBooleanMethodOOOO(jclass cls, jmethodID mid, jobject o1, jobject o2, jobject o3, jobject o4) = 0;
 	virtual jobject CallObjectMethodO(jobject obj, jmethodID mid, jobject o) = 0;
 	virtual jobject CallObjectMethodOO(jobject obj, jmethodID mid, jobject o1, jobject o2) = 0;
 	virtual jobject CallObjectMethodOOI(jobject obj, jmethodID mid, jobject o1, jobject o2, jint i1) = 0;
 	virtual jobject CallObjectMethod(jobject obj, jmethodID mid, jint ind) = 0;
+	virtual jobject CallObjectMethodII(jobject obj, jmethodID mid, jint i1, jint i2) = 0;
 	virtual jdouble CallDoubleMethod(jobject obj, jmethodID mid, ...) = 0;
 	virtual jobject CallObjectDoubleMethod(jobject obj, jmethodID mid, ...) = 0;
 	virtual jboolean CallBooleanMethod(jobject obj, jmethodID mid) = 0;
@@ -90,10 +109,18 @@ public:
 	virtual jstring NewStringUTF(const char* str) = 0;
 	virtual void DeleteLocalRef(jstring str) = 0;
 	virtual void DeleteLocalRef(jobject str) = 0;
+	virtual jobject NewGlobalRef(jobject obj) = 0;
+	virtual void DeleteGlobalRef(jobject obj) = 0;
+	virtual jobjectRefType GetObjectRefType(jobject obj) = 0;
 	virtual jobject NewObject(jclass cls, jmethodID constructor, jobject param) = 0;
 	virtual jobject NewObject(jclass cls, jmethodID constructor, jlong param) = 0;
 	virtual jintArray NewIntArray(int size) = 0;
 	virtual jdoubleArray NewDoubleArray(int size) = 0;
+	virtual jlongArray NewLongArray(int size) = 0;
+	virtual void GetIntArrayRegion(jintArray arr, int start, int length, jint* buffer) = 0;
+	virtual void GetDoubleArrayRegion(jdoubleArray arr, int start, int length, jdouble* buffer) = 0;
+	virtual void GetLongArrayRegion(jlongArray arr, int start, int length, jlong* buffer) = 0;
+	virtual void SetDoubleArrayRegion(jdoubleArray arr, int start, int length, const jdouble* buffer) = 0;
 	virtual jobjectArray NewObjectArray(int size, jclass cls) = 0;
 	virtual void SetIntField(jobject obj, jfieldID fld, jint val) = 0;
 	virtual void SetDoubleField(jobject obj, jfieldID fld, jdouble val) = 0;
@@ -105,4 +132,5 @@ public:
 	virtual jdouble GetDoubleField(jobject obj, jfieldID fid) = 0;
 	virtual jlong GetLongField(jobject obj, jfieldID fid) = 0;
 	virtual jboolean ExceptionCheck() = 0;
+	virtual void ExceptionClear() = 0;
 };
@@ -0,0 +1,49 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: mapped_file.h
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstddef>
+
+
+/**
+ * A read only view of a whole file mapped into memory.
+ */
+class MappedFile {
+public:
+	/**
+	 * Map a file into memory. Returns nullptr if the file can't be opened or mapped.
+	 */
+	static std::unique_ptr<MappedFile> open(const std::string& filename);
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	inline const char* data() const { return m_data; }
+	inline std::size_t size() const { return m_size; }
+
+private:
+	MappedFile() { }
+
+	const char* m_data{ nullptr };
+	std::size_t m_size{ 0 };
+	void* m_handle{ nullptr };
+};
@@ -0,0 +1,65 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: spline.h
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+
+/**
+ * A natural cubic spline through a set of hourly values, evaluated at every whole hour between
+ * the first and last known offsets.
+ *
+ * The knots are factored separately from the values. The tridiagonal system for the second
+ * derivatives only depends on the spacing of the offsets, so once the knots are set any number
+ * of value series can be fitted with a single forward and back substitution each.
+ */
+class NaturalCubicSpline {
+public:
+	/**
+	 * Set the hour offsets to interpolate between and factor the spline system for them. Returns
+	 * false if there are fewer than two offsets or they aren't strictly increasing.
+	 */
+	bool setKnots(const double* houroffsets, int size);
+	/**
+	 * Fit the spline to a set of values, one for each knot. setKnots must have succeeded first.
+	 */
+	void fit(const double* values);
+
+	/**
+	 * The first and last whole hours the spline covers.
+	 */
+	int firstHour() const;
+	int lastHour() const;
+	inline int hourCount() const { return lastHour() - firstHour() + 1; }
+
+	/**
+	 * Evaluate the fitted spline at every whole hour from firstHour to lastHour. result must
+	 * hold hourCount() values.
+	 */
+	void evaluateHours(double* result) const;
+
+private:
+	std::vector<double> m_x;
+	std::vector<double> m_h;
+	std::vector<double> m_cp;
+	std::vector<double> m_invDenom;
+	std::vector<double> m_y;
+	std::vector<double> m_m;
+};
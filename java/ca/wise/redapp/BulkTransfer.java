@@ -0,0 +1,228 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: BulkTransfer.java
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+package ca.wise.redapp;
+
+import java.lang.reflect.Array;
+import java.lang.reflect.Constructor;
+import java.lang.reflect.Field;
+import java.lang.reflect.Method;
+import java.util.List;
+
+/**
+ * Packs REDapp objects into primitive arrays, and unpacks them again, so the native wrapper can
+ * move them across JNI in a few bulk calls instead of one call per field. Fields are found by name through reflection so
+ * the adapter doesn't need the REDapp library to build and works whatever their visibility.
+ */
+public final class BulkTransfer {
+	/**
+	 * The double fields of a weather collection, in the order they are written to the columns.
+	 */
+	private static final String[] WEATHER_DOUBLES = { "hour", "temp", "rh", "wd", "ws", "wg", "precip",
+			"ffmc", "DMC", "DC", "BUI", "ISI", "FWI" };
+
+	/**
+	 * The fields of one weather collection class. Every field is null if the class doesn't have them all.
+	 */
+	private static final class WeatherFields {
+		final Field[] doubles;
+		final Field epoch;
+		final Field options;
+
+		WeatherFields(Class<?> type) {
+			Field[] d = new Field[WEATHER_DOUBLES.length];
+			Field e = null;
+			Field o = null;
+			try {
+				for (int i = 0; i < WEATHER_DOUBLES.length; i++)
+					d[i] = field(type, WEATHER_DOUBLES[i]);
+				e = field(type, "epoch");
+				o = field(type, "options");
+			}
+			catch (ReflectiveOperationException | RuntimeException ex) {
+				d = null;
+				e = null;
+				o = null;
+			}
+			doubles = d;
+			epoch = e;
+			options = o;
+		}
+	}
+
+	private static final ClassValue<WeatherFields> weatherFields = new ClassValue<WeatherFields>() {
+		@Override
+		protected WeatherFields computeValue(Class<?> type) {
+			return new WeatherFields(type);
+		}
+	};
+
+	/**
+	 * The spline method of one interpolator class and the point type it takes. Every member is
+	 * null if the class doesn't have a usable splineInterpolate.
+	 */
+	private static final class SplineMethod {
+		final Method interpolate;
+		final Constructor<?> point;
+		final Field houroffset;
+		final Field value;
+
+		SplineMethod(Class<?> type) {
+			Method m = null;
+			Constructor<?> p = null;
+			Field h = null;
+			Field v = null;
+			try {
+				for (Method candidate : type.getMethods()) {
+					Class<?>[] params = candidate.getParameterTypes();
+					if (candidate.getName().equals("splineInterpolate") && params.length == 1 && params[0].isArray() &&
+							!params[0].getComponentType().isPrimitive() && candidate.getReturnType() == params[0]) {
+						Class<?> pointType = params[0].getComponentType();
+						p = pointType.getDeclaredConstructor();
+						p.setAccessible(true);
+						h = field(pointType, "houroffset");
+						v = field(pointType, "value");
+						m = candidate;
+						break;
+					}
+				}
+			}
+			catch (ReflectiveOperationException | RuntimeException ex) {
+				m = null;
+			}
+			if (m == null) {
+				p = null;
+				h = null;
+				v = null;
+			}
+			interpolate = m;
+			point = p;
+			houroffset = h;
+			value = v;
+		}
+	}
+
+	private static final ClassValue<SplineMethod> splineMethods = new ClassValue<SplineMethod>() {
+		@Override
+		protected SplineMethod computeValue(Class<?> type) {
+			return new SplineMethod(type);
+		}
+	};
+
+	private BulkTransfer() { }
+
+	/**
+	 * Find a field declared by a class or any of its superclasses, the way JNI's GetFieldID does.
+	 */
+	static Field field(Class<?> type, String name) throws NoSuchFieldException {
+		for (Class<?> c = type; c != null; c = c.getSuperclass()) {
+			try {
+				Field field = c.getDeclaredField(name);
+				field.setAccessible(true);
+				return field;
+			}
+			catch (NoSuchFieldException e) {
+			}
+		}
+		throw new NoSuchFieldException(name);
+	}
+
+	/**
+	 * Copy a list of weather collections into column arrays.
+	 *
+	 * @param list The weather collections.
+	 * @param values The double fields, column after column in the order of WEATHER_DOUBLES. Must hold
+	 *            WEATHER_DOUBLES.length * list.size() values.
+	 * @param epochs The epoch of each collection. Must hold list.size() values.
+	 * @param options The options of each collection. Must hold list.size() values.
+	 * @return false if the list doesn't hold weather collections or the arrays are too small, in
+	 *         which case the arrays may have been partly written.
+	 */
+	public static boolean weatherColumns(List<?> list, double[] values, long[] epochs, int[] options) {
+		int size = list.size();
+		if (size == 0)
+			return true;
+		if (epochs.length < size || options.length < size || (long)values.length < (long)size * WEATHER_DOUBLES.length)
+			return false;
+		Object first = list.get(0);
+		if (first == null)
+			return false;
+		Class<?> type = first.getClass();
+		WeatherFields fields = weatherFields.get(type);
+		if (fields.doubles == null)
+			return false;
+		try {
+			int i = 0;
+			for (Object row : list) {
+				if (row == null || row.getClass() != type)
+					return false;
+				for (int c = 0; c < fields.doubles.length; c++)
+					values[c * size + i] = fields.doubles[c].getDouble(row);
+				epochs[i] = fields.epoch.getLong(row);
+				options[i] = fields.options.getInt(row);
+				i++;
+			}
+		}
+		catch (IllegalAccessException | IllegalArgumentException e) {
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Spline interpolate hourly values with an interpolator that takes and returns an array of
+	 * HourValue points, so the native wrapper can pass primitive arrays instead of building a
+	 * point object per value over JNI.
+	 *
+	 * @param interpolator The interpolator to run.
+	 * @param houroffsets The hour offset of each value.
+	 * @param values The values to interpolate. Must be the same length as houroffsets.
+	 * @return The interpolated hour offsets followed by the interpolated values, or null if the
+	 *         interpolator doesn't have a usable splineInterpolate or it failed.
+	 */
+	public static double[][] splineInterpolate(Object interpolator, double[] houroffsets, double[] values) {
+		if (interpolator == null || houroffsets.length != values.length)
+			return null;
+		SplineMethod spline = splineMethods.get(interpolator.getClass());
+		if (spline.interpolate == null)
+			return null;
+		try {
+			Object points = Array.newInstance(spline.point.getDeclaringClass(), houroffsets.length);
+			for (int i = 0; i < houroffsets.length; i++) {
+				Object point = spline.point.newInstance();
+				spline.houroffset.setDouble(point, houroffsets[i]);
+				spline.value.setDouble(point, values[i]);
+				Array.set(points, i, point);
+			}
+			Object result = spline.interpolate.invoke(interpolator, points);
+			if (result == null)
+				return null;
+			int len = Array.getLength(result);
+			double[][] retval = { new double[len], new double[len] };
+			for (int i = 0; i < len; i++) {
+				Object point = Array.get(result, i);
+				retval[0][i] = spline.houroffset.getDouble(point);
+				retval[1][i] = spline.value.getDouble(point);
+			}
+			return retval;
+		}
+		catch (ReflectiveOperationException | RuntimeException e) {
+			return null;
+		}
+	}
+}
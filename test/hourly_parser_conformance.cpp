@@ -0,0 +1,129 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: hourly_parser_conformance.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Imports every file in a directory of hourly weather files through Java and through the native
+ * parser and compares them field by field, printing the first difference in each column. Files
+ * the native parser doesn't accept are skipped since they're always left to Java.
+ *
+ * usage: hourly_parser_conformance <corpus directory> [timezone in seconds]
+ *
+ * Exits with 0 if every compared file matched, 1 if any differed and 77 if no file could be
+ * compared.
+ */
+
+#include "types.h"
+#include "ICWFGM_Weather.h"
+#include "REDappWrapper.h"
+#include "hourly_parser.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+using namespace REDapp;
+
+
+/**
+ * Compare one column of two series, printing the first row that differs.
+ */
+template<typename _Column>
+static bool SameColumn(const std::string& file, const char* name, const _Column& java, const _Column& native) {
+	for (size_t i = 0; i < java.size(); i++) {
+		if (java[i] != native[i]) {
+			std::printf("%s: %s differs from row %zu, Java %.17g native %.17g\n", file.c_str(), name, i,
+				(double)java[i], (double)native[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool SameSeries(const std::string& file, const WeatherSeries& java, const WeatherSeries& native) {
+	if (java.size() != native.size()) {
+		std::printf("%s: Java read %zu hours, native %zu\n", file.c_str(), java.size(), native.size());
+		return false;
+	}
+	//check every column rather than stopping at the first so one run shows every convention that's off
+	bool same = SameColumn(file, "hour", java.hour, native.hour);
+	same &= SameColumn(file, "epoch", java.epoch, native.epoch);
+	same &= SameColumn(file, "temp", java.temp, native.temp);
+	same &= SameColumn(file, "rh", java.rh, native.rh);
+	same &= SameColumn(file, "wd", java.wd, native.wd);
+	same &= SameColumn(file, "ws", java.ws, native.ws);
+	same &= SameColumn(file, "wg", java.wg, native.wg);
+	same &= SameColumn(file, "precip", java.precip, native.precip);
+	same &= SameColumn(file, "ffmc", java.ffmc, native.ffmc);
+	same &= SameColumn(file, "DMC", java.DMC, native.DMC);
+	same &= SameColumn(file, "DC", java.DC, native.DC);
+	same &= SameColumn(file, "BUI", java.BUI, native.BUI);
+	same &= SameColumn(file, "ISI", java.ISI, native.ISI);
+	same &= SameColumn(file, "FWI", java.FWI, native.FWI);
+	same &= SameColumn(file, "options", java.options, native.options);
+	return same;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s <corpus directory> [timezone in seconds]\n", argv[0]);
+		return 2;
+	}
+	HourlyParser::Settings settings;
+	if (argc > 2)
+		settings.timezone = std::strtoll(argv[2], nullptr, 10);
+	if (!REDappWrapper::CanLoadJava()) {
+		std::fprintf(stderr, "Java couldn't be loaded: %s\n", REDappWrapper::GetErrorDescription().c_str());
+		return 77;
+	}
+
+	JavaWeatherStream stream;
+	stream.setTimezone(settings.timezone);
+	stream.setImportParser(JavaWeatherStream::ImportParser::JAVA);
+
+	size_t compared = 0, skipped = 0, failed = 0;
+	std::error_code ec;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(argv[1], ec)) {
+		if (!entry.is_regular_file())
+			continue;
+		std::string file = entry.path().string();
+		WeatherSeries native;
+		if (!HourlyParser::parseFile(file, settings, native)) {
+			skipped++;
+			continue;
+		}
+		WeatherSeries java;
+		long hr = stream.importHourly(file, java);
+		if (hr != 0) {
+			std::printf("%s: the native parser accepted a file Java imported with result %ld\n", file.c_str(), hr);
+			failed++;
+		}
+		else if (!SameSeries(file, java, native))
+			failed++;
+		compared++;
+	}
+	if (ec) {
+		std::fprintf(stderr, "%s: %s\n", argv[1], ec.message().c_str());
+		return 2;
+	}
+
+	std::printf("%zu files compared, %zu differed, %zu not accepted by the native parser\n", compared, failed, skipped);
+	if (compared == 0)
+		return 77;
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * WISE_REDapp_Lib_Wrapper: spline_engines.cpp
+ * Copyright (C) 2023  WISE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Interpolates the same series with the Java and native spline engines and checks that every
+ * interpolated hour matches to within Interpolator::SplineTolerance.
+ *
+ * usage: spline_engines
+ *
+ * Exits with 0 if every series matched, 1 if any differed and 77 if Java couldn't be loaded.
+ */
+
+#include "types.h"
+#include "ICWFGM_Weather.h"
+#include "REDappWrapper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace REDapp;
+
+
+/**
+ * Make a strictly increasing set of hour offsets. step is the spacing, or 0 for irregular
+ * spacing of 1 to 6 hours.
+ */
+static std::vector<double> Offsets(std::mt19937& random, int size, double start, int step) {
+	std::uniform_int_distribution<int> gap(1, 6);
+	std::vector<double> offsets(size);
+	double offset = start;
+	for (int i = 0; i < size; i++) {
+		offsets[i] = offset;
+		offset += step ? step : gap(random);
+	}
+	return offsets;
+}
+
+static bool Matches(const std::vector<std::pair<int, double>>& java, const std::vector<std::pair<int, double>>& native, const char* name) {
+	if (java.size() != native.size()) {
+		std::printf("%s: Java interpolated %zu hours, native %zu\n", name, java.size(), native.size());
+		return false;
+	}
+	for (size_t i = 0; i < java.size(); i++) {
+		double allowed = Interpolator::SplineTolerance * std::max(1.0, std::fabs(java[i].second));
+		if (java[i].first != native[i].first || std::fabs(java[i].second - native[i].second) > allowed) {
+			std::printf("%s: hour %zu differs, Java (%d, %.17g) native (%d, %.17g)\n", name, i,
+				java[i].first, java[i].second, native[i].first, native[i].second);
+			return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	if (!REDappWrapper::CanLoadJava()) {
+		std::fprintf(stderr, "Java couldn't be loaded: %s\n", REDappWrapper::GetErrorDescription().c_str());
+		return 77;
+	}
+
+	struct Case {
+		const char* name;
+		int size;
+		double start;
+		int step;
+	};
+	const Case cases[] = {
+		{ "two points", 2, 0.0, 3 },
+		{ "three points", 3, 0.0, 1 },
+		{ "hourly", 24, 0.0, 1 },
+		{ "three hourly", 40, 0.0, 3 },
+		{ "six hourly", 40, 12.0, 6 },
+		{ "irregular", 60, 0.0, 0 },
+		{ "fractional start", 30, 0.5, 3 },
+		{ "negative start", 30, -7.0, 3 }
+	};
+
+	std::mt19937 random(20230401);
+	std::uniform_real_distribution<double> value(-30.0, 40.0);
+	Interpolator interpolator;
+	int failed = 0;
+	SplineStatistics before = REDappWrapper::GetSplineStatistics();
+	for (const Case& c : cases) {
+		for (int repeat = 0; repeat < 10; repeat++) {
+			std::vector<double> offsets = Offsets(random, c.size, c.start, c.step);
+			std::vector<double> values(c.size);
+			for (double& v : values)
+				v = value(random);
+
+			interpolator.setEngine(Interpolator::SplineEngine::JAVA);
+			auto java = interpolator.SplineInterpolate(offsets.data(), values.data(), c.size);
+			interpolator.setEngine(Interpolator::SplineEngine::NATIVE);
+			auto native = interpolator.SplineInterpolate(offsets.data(), values.data(), c.size);
+			if (!Matches(java, native, c.name)) {
+				failed++;
+				break;
+			}
+		}
+	}
+
+	//make sure the native engine computed the splines rather than falling back to Java
+	SplineStatistics after = REDappWrapper::GetSplineStatistics();
+	std::uint64_t fallbacks = after.javaFallbacks - before.javaFallbacks;
+	if (fallbacks)
+		std::printf("the native engine fell back to Java %llu times\n", (unsigned long long)fallbacks);
+
+	std::printf("%d of %zu cases differed\n", failed, std::size(cases));
+	return (failed || fallbacks) ? 1 : 0;
+}